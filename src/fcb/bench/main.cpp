@@ -0,0 +1,465 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "core/GameObject.h"
+#include "core/Globals.h"
+#include "core/NearestNeighbor.h"
+#include "core/SpatialGrid.h"
+#include "core/Simulation.h"
+#include "ml/Activation.h"
+#include "ml/GeneticAlgorithmPairing.h"
+#include "ml/NeuralNet.h"
+#include "ml/NeuralNetPopulation.h"
+#include "util/Rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::core;
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t constexpr c_numInputs = 1024;  // Benchmark inputs cycle through this many values, so the branch predictor can't learn them.
+size_t constexpr c_batchSize = 1000;  // Networks in the batch feed-forward benchmark.
+
+//! Command line options.
+struct Options
+{
+    bool json = false;
+    std::string filter;                          // Only run benchmarks whose name contains this.
+    double minTime = 0.5;                        // Seconds to spend timing each benchmark, not counting calibration.
+    size_t numSamples = 5;
+    uint64_t seed = 1;
+    size_t numThreads = 1;                       // For the whole-generation benchmarks.
+    std::vector<size_t> populations { 50, 200, 1000 };  // Population sizes for the whole-generation benchmarks.
+};
+
+char const* const c_usage =
+    "Usage: FcbBench [options]\n"
+    "  --format csv|json       Output format. Default csv.\n"
+    "  --filter TEXT           Only run benchmarks whose name contains TEXT.\n"
+    "  --min-time SECONDS      Time to spend measuring each benchmark. Default 0.5.\n"
+    "  --samples N             Split the measuring time into N samples. Default 5.\n"
+    "  --seed N                Seed for the inputs. Default 1.\n"
+    "  --threads N             Threads for the whole-generation benchmarks. Default 1. 0 uses one per hardware thread.\n"
+    "  --populations A,B,...   Population sizes for the whole-generation benchmarks. Default 50,200,1000.\n";
+
+//! The timing of one benchmark.
+struct Result
+{
+    std::string name;
+    size_t numSamples;
+    size_t iterationsPerSample;
+    double nsPerOpMedian;
+    double nsPerOpMin;
+    double nsPerOpMax;
+};
+
+//! Parse the command line.
+//! @param[in]  argc        From main.
+//! @param[in]  argv        From main.
+//! @param[out] out_options The parsed options. Options not on the command line keep their defaults.
+//! @return false if the command line was bad.
+bool parseOptions(int const argc, char* argv[], Options& out_options)
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            return false;
+        std::string const name = argv[i];
+        char const* const value = argv[i + 1];
+
+        if (name == "--format" && std::strcmp(value, "csv") == 0)
+            out_options.json = false;
+        else if (name == "--format" && std::strcmp(value, "json") == 0)
+            out_options.json = true;
+        else if (name == "--filter")
+            out_options.filter = value;
+        else if (name == "--min-time")
+            out_options.minTime = std::max(std::strtod(value, nullptr), 0.0);
+        else if (name == "--samples")
+            out_options.numSamples = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (name == "--seed")
+            out_options.seed = std::strtoull(value, nullptr, 10);
+        else if (name == "--threads")
+            out_options.numThreads = std::strtoul(value, nullptr, 10);
+        else if (name == "--populations")
+        {
+            out_options.populations.clear();
+            std::istringstream list(value);
+            for (std::string item; std::getline(list, item, ',');)
+                out_options.populations.push_back(std::max<size_t>(std::strtoul(item.c_str(), nullptr, 10), 1));
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+//! Keeps the optimizer from deleting work whose result is otherwise unused.
+template <typename T>
+void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static void const* volatile s_escape;
+    s_escape = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+//! @return The time one call to body takes, in seconds.
+template <typename Body>
+double timeOnce(Body& body, size_t const iterations)
+{
+    auto const start = Clock::now();
+    body(iterations);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//! Time a benchmark.
+//! First doubles the number of iterations until one sample takes long enough to time accurately,
+//! then times several samples of that many iterations.
+//! @param[in] name    The name of the benchmark.
+//! @param[in] options How long to measure.
+//! @param[in] body    A callable that runs the benchmark. Signature must be (size_t iterations) -> void.
+//! @return The time per iteration.
+template <typename Body>
+Result measure(std::string name, Options const& options, Body&& body)
+{
+    double const sampleTime = options.minTime / static_cast<double>(options.numSamples);
+    size_t iterations = 1;
+    for (double elapsed = timeOnce(body, iterations); elapsed < sampleTime; elapsed = timeOnce(body, iterations))
+    {
+        // Aim a little past the target, but at most 10x more at a time, in case the first runs were noisy.
+        double const scale = (elapsed > 0) ? std::min(1.2 * sampleTime / elapsed, 10.0) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<size_t>(static_cast<double>(iterations) * scale));
+    }
+
+    std::vector<double> nsPerOp;
+    for (size_t i = 0; i < options.numSamples; ++i)
+        nsPerOp.push_back(timeOnce(body, iterations) * 1e9 / static_cast<double>(iterations));
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    return { std::move(name), nsPerOp.size(), iterations, nsPerOp[nsPerOp.size() / 2], nsPerOp.front(), nsPerOp.back() };
+}
+
+//! Runs the benchmarks that match the filter, and collects the results.
+class Runner
+{
+public:
+    explicit Runner(Options const& options)
+        : m_options(options)
+    { }
+
+    //! Run a benchmark if its name matches the filter.
+    //! @param[in] name  The name of the benchmark.
+    //! @param[in] setup A callable that prepares the benchmark and returns its body. Only called if the benchmark runs.
+    //!                  The body's signature must be (size_t iterations) -> void.
+    template <typename Setup>
+    void Run(std::string const& name, Setup&& setup)
+    {
+        if (name.find(m_options.filter) == std::string::npos)
+            return;
+
+        // Every benchmark starts from the same random state, so each one does the same work every run.
+        util::RngGlobalInstance().SetSeed(m_options.seed);
+        m_results.push_back(measure(name, m_options, setup()));
+        std::cerr << name << ": " << m_results.back().nsPerOpMedian << " ns" << std::endl;
+    }
+
+    std::vector<Result> const& Results() const
+    {
+        return m_results;
+    }
+
+private:
+    Options const& m_options;
+    std::vector<Result> m_results;
+};
+
+//! @return Random points in the world.
+std::vector<float> randomCoordinates(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> dist(Globals::c_worldLeftBound, Globals::c_worldRightBound);
+    std::vector<float> coordinates(count);
+    for (float& coordinate : coordinates)
+        coordinate = dist(rng);
+    return coordinates;
+}
+
+//! Register every benchmark with the runner.
+void runBenchmarks(Runner& runner, Options const& options)
+{
+    runner.Run("NeuralNet::FeedForward", [] {
+        return [net = ml::NeuralNet(Globals::c_numHiddenNodes)](size_t const iterations) {
+            ml::NeuralNet::InputType inputs;
+            ml::NeuralNet::OutputType outputs;
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                for (Eigen::Index j = 0; j < ml::NeuralNet::NUM_INPUTS; ++j)
+                    inputs(j) = static_cast<float>((i + static_cast<size_t>(j)) % 7) / 7;
+                net.FeedForward(inputs, outputs);
+                doNotOptimize(outputs);
+            }
+        };
+    });
+
+    // One per activation function, on both layers. The default keeps the plain name, so results compare with older runs.
+    for (size_t a = 0; a < ml::c_numActivations; ++a)
+    {
+        auto const activation = static_cast<ml::Activation>(a);
+        std::string const suffix = activation == ml::Activation::Sigmoid ? "" : std::string("/") + ml::ActivationName(activation);
+        runner.Run("NeuralNetPopulation::FeedForward/" + std::to_string(c_batchSize) + suffix, [activation] {
+            auto brains = std::make_shared<ml::NeuralNetPopulation>(c_batchSize, Globals::c_numHiddenNodes);
+            brains->SetActivations({ activation, activation });
+            util::Philox4x32 rng(1);
+            for (size_t i = 0; i < c_batchSize; ++i)
+                brains->Randomize(i, rng);
+            auto inputs = std::make_shared<ml::NeuralNetPopulation::InputBatchType>(c_batchSize);
+            for (size_t i = 0; i < c_batchSize; ++i)
+                for (Eigen::Index j = 0; j < ml::NeuralNet::NUM_INPUTS; ++j)
+                    (*inputs)(i, j) = static_cast<float>((i + static_cast<size_t>(j)) % 7) / 7;
+            return [brains, inputs](size_t const iterations) {
+                ml::NeuralNetPopulation::OutputBatchType outputs(c_batchSize, ml::NeuralNet::NUM_OUTPUTS);
+                auto scratch = brains->HiddenBatch();
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    brains->FeedForward(*inputs, outputs, scratch, 0, c_batchSize);
+                    doNotOptimize(outputs);
+                }
+            };
+        });
+    }
+
+    for (size_t a = 0; a < ml::c_numActivations; ++a)
+    {
+        auto const activation = static_cast<ml::Activation>(a);
+        runner.Run(std::string("Activate/") + ml::ActivationName(activation) + "/1024", [activation] {
+            // Values around the bend of every curve. Each function maps them back into a small range, so repeating it stays finite.
+            auto values = std::make_shared<std::vector<float>>(1024);
+            for (size_t i = 0; i < values->size(); ++i)
+                (*values)[i] = static_cast<float>(i % 17) / 2 - 4;
+            return [activation, values](size_t const iterations) {
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    ml::Activate(activation, values->data(), values->size());
+                    doNotOptimize((*values)[0]);
+                }
+            };
+        });
+    }
+
+    runner.Run("NeuralNet::Crossover", [] {
+        return [m = ml::NeuralNet(Globals::c_numHiddenNodes), f = ml::NeuralNet(Globals::c_numHiddenNodes)](size_t const iterations) {
+            ml::NeuralNet c(Globals::c_numHiddenNodes);
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                ml::NeuralNet::Crossover(m, f, c);
+                doNotOptimize(c);
+            }
+        };
+    });
+
+    runner.Run("breedFloat", [] {
+        return [](size_t const iterations) {
+            for (size_t i = 0; i < iterations; ++i)
+                doNotOptimize(ml::breedFloat(.25f, .75f));
+        };
+    });
+
+    runner.Run("breedFloat (Philox4x32)", [&options] {
+        return [rng = util::Philox4x32(options.seed)](size_t const iterations) mutable {
+            for (size_t i = 0; i < iterations; ++i)
+                doNotOptimize(ml::breedFloat(.25f, .75f, rng));
+        };
+    });
+
+    runner.Run("selectIndex50", [] {
+        return [](size_t const iterations) {
+            for (size_t i = 0; i < iterations; ++i)
+                doNotOptimize(ml::selectIndex50());
+        };
+    });
+
+    for (size_t const numClovers : { size_t(200), size_t(1000), size_t(10000) })
+    {
+        runner.Run("SpatialGrid::Nearest/" + std::to_string(numClovers), [&options, numClovers] {
+            util::Philox4x32 rng(options.seed);
+            auto grid = std::make_shared<SpatialGrid>(SpatialGrid::CellsPerSideFor(numClovers));
+            std::vector<float> const x = randomCoordinates(numClovers, rng);
+            std::vector<float> const y = randomCoordinates(numClovers, rng);
+            for (size_t i = 0; i < numClovers; ++i)
+                grid->Insert(i, x[i], y[i]);
+            return [grid, queryX = randomCoordinates(c_numInputs, rng), queryY = randomCoordinates(c_numInputs, rng)](size_t const iterations) {
+                for (size_t i = 0; i < iterations; ++i)
+                    doNotOptimize(grid->Nearest(queryX[i % c_numInputs], queryY[i % c_numInputs]));
+            };
+        });
+
+        runner.Run("NearestBruteForce/" + std::to_string(numClovers), [&options, numClovers] {
+            util::Philox4x32 rng(options.seed);
+            auto x = std::make_shared<std::vector<float>>(randomCoordinates(numClovers, rng));
+            auto y = std::make_shared<std::vector<float>>(randomCoordinates(numClovers, rng));
+            return [x, y, queryX = randomCoordinates(c_numInputs, rng), queryY = randomCoordinates(c_numInputs, rng)](size_t const iterations) {
+                for (size_t i = 0; i < iterations; ++i)
+                    doNotOptimize(NearestBruteForce(queryX[i % c_numInputs], queryY[i % c_numInputs], x->data(), y->data(), x->size()));
+            };
+        });
+
+        // Every query at once, as Simulation asks. One iteration is c_numInputs queries.
+        runner.Run("SpatialGrid::Nearest (batch of " + std::to_string(c_numInputs) + ")/" + std::to_string(numClovers), [&options, numClovers] {
+            util::Philox4x32 rng(options.seed);
+            auto grid = std::make_shared<SpatialGrid>(SpatialGrid::CellsPerSideFor(numClovers));
+            std::vector<float> const x = randomCoordinates(numClovers, rng);
+            std::vector<float> const y = randomCoordinates(numClovers, rng);
+            for (size_t i = 0; i < numClovers; ++i)
+                grid->Insert(i, x[i], y[i]);
+            return [grid, queryX = randomCoordinates(c_numInputs, rng), queryY = randomCoordinates(c_numInputs, rng)](size_t const iterations) {
+                std::vector<size_t> nearest(c_numInputs);
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    grid->Nearest(queryX.data(), queryY.data(), c_numInputs, nearest.data());
+                    doNotOptimize(nearest[0]);
+                }
+            };
+        });
+
+        runner.Run("NearestBruteForce (batch of " + std::to_string(c_numInputs) + ")/" + std::to_string(numClovers), [&options, numClovers] {
+            util::Philox4x32 rng(options.seed);
+            auto x = std::make_shared<std::vector<float>>(randomCoordinates(numClovers, rng));
+            auto y = std::make_shared<std::vector<float>>(randomCoordinates(numClovers, rng));
+            return [x, y, queryX = randomCoordinates(c_numInputs, rng), queryY = randomCoordinates(c_numInputs, rng)](size_t const iterations) {
+                std::vector<size_t> nearest(c_numInputs);
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    NearestBruteForce(queryX.data(), queryY.data(), c_numInputs, x->data(), y->data(), x->size(), nearest.data());
+                    doNotOptimize(nearest[0]);
+                }
+            };
+        });
+    }
+
+    runner.Run("GameObject::CalcVectorTo", [&options] {
+        util::Philox4x32 rng(options.seed);
+        std::vector<float> const x = randomCoordinates(c_numInputs, rng);
+        std::vector<float> const y = randomCoordinates(c_numInputs, rng);
+        std::vector<GameObject> objects(c_numInputs);
+        for (size_t i = 0; i < c_numInputs; ++i)
+        {
+            objects[i].X() = x[i];
+            objects[i].Y() = y[i];
+        }
+        return [objects = std::move(objects)](size_t const iterations) {
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                float dx;
+                float dy;
+                objects[i % c_numInputs].CalcVectorTo(objects[(i + 1) % c_numInputs], dx, dy);
+                doNotOptimize(dx);
+                doNotOptimize(dy);
+            }
+        };
+    });
+
+    for (size_t const numBunnies : options.populations)
+    {
+        runner.Run("Simulation::generation/" + std::to_string(numBunnies), [&options, numBunnies] {
+            SimulationSettings settings;
+            settings.numBunnies = numBunnies;
+            settings.numClovers = std::max<size_t>(numBunnies * 4, 200);  // The default ratio.
+            settings.numThreads = options.numThreads;
+            settings.seed = options.seed;
+            auto simulation = std::make_shared<Simulation>(settings);
+            return [simulation](size_t const iterations) {
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    simulation->RunGeneration();
+                    doNotOptimize(simulation->NextGeneration());
+                }
+            };
+        });
+    }
+}
+
+//! Write the results as CSV, one row per benchmark.
+void writeCsv(std::ostream& out, std::vector<Result> const& results)
+{
+    out << "name,samples,iterations_per_sample,ns_per_op_median,ns_per_op_min,ns_per_op_max\n";
+    for (Result const& result : results)
+    {
+        out << '"' << result.name << "\"," << result.numSamples << ',' << result.iterationsPerSample << ','
+            << result.nsPerOpMedian << ',' << result.nsPerOpMin << ',' << result.nsPerOpMax << '\n';
+    }
+}
+
+//! Write the results as JSON, with the options they were run with.
+void writeJson(std::ostream& out, std::vector<Result> const& results, Options const& options)
+{
+    out << "{\n"
+        << "  \"context\": { \"seed\": " << options.seed << ", \"threads\": " << options.numThreads
+        << ", \"samples\": " << options.numSamples << ", \"min_time\": " << options.minTime << " },\n"
+        << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        Result const& result = results[i];
+        out << "    { \"name\": \"" << result.name << "\", \"samples\": " << result.numSamples
+            << ", \"iterations_per_sample\": " << result.iterationsPerSample
+            << ", \"ns_per_op_median\": " << result.nsPerOpMedian << ", \"ns_per_op_min\": " << result.nsPerOpMin
+            << ", \"ns_per_op_max\": " << result.nsPerOpMax << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+}  // Anonymous namespace.
+
+
+//! Times the hot paths. Progress goes to stderr, and the results go to stdout. See c_usage for the options.
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << c_usage;
+        return 1;
+    }
+
+    Runner runner(options);
+    runBenchmarks(runner, options);
+
+    if (options.json)
+        writeJson(std::cout, runner.Results(), options);
+    else
+        writeCsv(std::cout, runner.Results());
+
+    return 0;
+}
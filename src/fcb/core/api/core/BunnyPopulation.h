@@ -0,0 +1,82 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "ml/NeuralNetPopulation.h"
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace fcb { namespace core {
+
+//! Holds the game state for a whole population of bunnies.
+//! Structure-of-arrays: a bunny is an index, and each property lives in its own contiguous array,
+//! so Think, Act, and EnforceBounds sweep memory linearly instead of chasing one heap object per bunny.
+class BunnyPopulation
+{
+public:
+    explicit BunnyPopulation(size_t const size);
+
+    size_t Size() const;
+
+    float  X(size_t const index) const;
+    float& X(size_t const index);
+    float  Y(size_t const index) const;
+    float& Y(size_t const index);
+    float  Angle(size_t const index) const;
+    float& Angle(size_t const index);
+    float  Radius(size_t const index) const;
+    float& Radius(size_t const index);
+    unsigned  NumCloversEaten(size_t const index) const;
+    unsigned& NumCloversEaten(size_t const index);
+
+    void Think(std::vector<float> const& targetX, std::vector<float> const& targetY);
+    void Think(std::vector<float> const& targetX, std::vector<float> const& targetY, size_t const begin, size_t const end);
+    void Act();
+    void Act(size_t const begin, size_t const end);
+    void EnforceBounds();
+    void EnforceBounds(size_t const begin, size_t const end);
+
+    Eigen::VectorXf Genome(size_t const index) const;
+    void SetGenome(size_t const index, Eigen::VectorXf const& genome);
+    void RandomizeBrain(size_t const index, util::Philox4x32& rng);
+    ml::Activations GetActivations() const;
+    void SetActivations(ml::Activations const activations);
+
+    void Save(std::ostream& out) const;
+    bool Load(std::istream& in);
+    void BreedChild(size_t const m, size_t const f, size_t const c, util::Philox4x32& rng);
+    void NextGeneration();
+
+private:
+    float m_speed = .0028f;
+
+    std::vector<float>    m_x;
+    std::vector<float>    m_y;
+    std::vector<float>    m_angle;
+    std::vector<float>    m_radius;
+    std::vector<unsigned> m_numCloversEaten;
+    fcb::ml::NeuralNetPopulation::InputBatchType  m_inputs;
+    fcb::ml::NeuralNetPopulation::OutputBatchType m_outputs;
+    fcb::ml::NeuralNetPopulation m_brains;
+    fcb::ml::NeuralNetPopulation::HiddenBatchType m_hidden;  // Scratch space for Think, kept so thinking doesn't allocate.
+};
+
+} }
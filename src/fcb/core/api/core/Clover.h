@@ -28,8 +28,10 @@ class Clover : public GameObject
 public:
     Clover();
 
-    unsigned Hp() const;
+    unsigned  Hp() const;
+    unsigned& Hp();
     bool Bite();
+    void Respawn(float const x, float const y);
 
 private:
     unsigned m_hp;
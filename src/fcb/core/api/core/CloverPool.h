@@ -0,0 +1,53 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "core/Clover.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace fcb { namespace core {
+
+//! A fixed number of clovers, stored side by side.
+//! A clover that is eaten is respawned in place rather than replaced, so once the pool is full, clovers are never created or destroyed.
+class CloverPool
+{
+public:
+    explicit CloverPool(size_t const capacity = 0);
+
+    CloverPool(CloverPool const&)            = delete;
+    CloverPool(CloverPool&&)                 = default;
+    CloverPool& operator=(CloverPool const&) = delete;
+    CloverPool& operator=(CloverPool&&)      = default;
+
+    size_t Size() const;
+    size_t Capacity() const;
+
+    Clover const& operator[](size_t const index) const;
+    Clover&       operator[](size_t const index);
+
+    size_t Spawn(float const x, float const y);
+    void Respawn(size_t const index, float const x, float const y);
+
+private:
+    std::vector<Clover> m_clovers;  // Reserved to the capacity up front and never grown past it, so the clovers never move.
+};
+
+} }
@@ -19,30 +19,40 @@
 #pragma once
 
 #include "core/GameObject.h"
+#include "core/Globals.h"
+#include "ml/FixedNeuralNet.h"
 #include "ml/NeuralNet.h"
+#include "util/Rng.h"
 
-namespace fcb { namespace core {
+#include <Eigen/Dense>
 
-class Bunny;
+namespace fcb { namespace core {
 
 //! Holds the game state for a fox.
 class Fox : public GameObject
 {
 public:
+    //! The fox's brain. The topology is known at compile time, so the weights are stored inline.
+    using Brain = fcb::ml::FixedNeuralNet<fcb::ml::NeuralNet::NUM_INPUTS, Globals::c_numHiddenNodes, fcb::ml::NeuralNet::NUM_OUTPUTS>;
+
     Fox();
 
     unsigned  NumBunniesEaten() const;
     unsigned& NumBunniesEaten();
-    void Think(Bunny const& nearestBunny);
+    void Think(float const targetX, float const targetY);
     void Act();
 
-    static void Crossover(Fox const& m, Fox const& f, Fox& out_c);
+    void RandomizeBrain(util::Philox4x32& rng);
+    Eigen::VectorXf Genome() const;
+    void SetGenome(Eigen::VectorXf const& genome);
+
+    static void Crossover(Fox const& m, Fox const& f, Fox& out_c, util::Philox4x32& rng);
 
 private:
     unsigned m_numBunniesEaten = 0;
     float m_speed = .0034f;
-    fcb::ml::NeuralNet m_brain;
-    fcb::ml::NeuralNet::OutputType m_outputs;
+    Brain m_brain;
+    Brain::OutputType m_outputs;
 };
 
 } }
@@ -0,0 +1,82 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "core/Globals.h"
+
+namespace fcb { namespace core {
+
+// World-space helpers shared by GameObject and the spatial indexes.
+// Defined inline because they sit in the innermost loops.
+
+//! @param[in] from   A coordinate.
+//! @param[in] to     Another coordinate on the same axis.
+//! @param[in] extent The size of the world along this axis.
+//! @return The displacement from one coordinate to the other. If the world wraps, this is the shorter way around.
+inline float WrapDelta(float const from, float const to, float const extent)
+{
+    float delta = to - from;
+    if constexpr (Globals::c_worldWrap)
+    {
+        if (delta > extent / 2)
+            delta -= extent;
+        else if (delta < -extent / 2)
+            delta += extent;
+    }
+    return delta;
+}
+
+//! @return The displacement along the x-axis from one x-coordinate to another.
+inline float DeltaX(float const fromX, float const toX)
+{
+    return WrapDelta(fromX, toX, Globals::c_worldRightBound - Globals::c_worldLeftBound);
+}
+
+//! @return The displacement along the y-axis from one y-coordinate to another.
+inline float DeltaY(float const fromY, float const toY)
+{
+    return WrapDelta(fromY, toY, Globals::c_worldTopBound - Globals::c_worldBottomBound);
+}
+
+//! @return The square of the distance between two points, taking the world wrap into account.
+inline float DistanceSquared(float const x0, float const y0, float const x1, float const y1)
+{
+    float const dx = DeltaX(x0, x1);
+    float const dy = DeltaY(y0, y1);
+    return dx * dx + dy * dy;
+}
+
+//! Keep a point inside the world bounds.
+//! If the world wraps, a point that leaves one side comes back on the other. Otherwise it is clamped to the edge.
+//! @param[in/out] inout_x The x-coordinate of the point.
+//! @param[in/out] inout_y The y-coordinate of the point.
+inline void EnforceBounds(float& inout_x, float& inout_y)
+{
+    if (inout_x > Globals::c_worldRightBound)
+        inout_x = Globals::c_worldWrap ? Globals::c_worldLeftBound : Globals::c_worldRightBound;
+    else if (inout_x < Globals::c_worldLeftBound)
+        inout_x = Globals::c_worldWrap ? Globals::c_worldRightBound : Globals::c_worldLeftBound;
+
+    if (inout_y > Globals::c_worldTopBound)
+        inout_y = Globals::c_worldWrap ? Globals::c_worldBottomBound : Globals::c_worldTopBound;
+    else if (inout_y < Globals::c_worldBottomBound)
+        inout_y = Globals::c_worldWrap ? Globals::c_worldTopBound : Globals::c_worldBottomBound;
+}
+
+} }
@@ -27,6 +27,7 @@ struct Globals
     static unsigned constexpr c_numHiddenNodes = 6;  // The number of nodes in the neural network's hidden layer.
     static unsigned constexpr c_cloverHp = 1;  // How many bites the clovers have in them before they are consumed.
     static unsigned constexpr c_secondsPerGeneration = 15;  // The runtime for one generation.
+    static unsigned constexpr c_cyclesPerSecond = 60;  // The number of simulation cycles in one second of game time.
 
     static float constexpr c_worldLeftBound   = -1;
     static float constexpr c_worldRightBound  =  1;
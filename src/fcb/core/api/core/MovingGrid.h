@@ -0,0 +1,62 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "util/ThreadPool.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace fcb { namespace core {
+
+//! A uniform grid over the world bounds for nearest-neighbor queries among items that all move every cycle, like bunnies.
+//! Instead of being told about each move, as SpatialGrid is, it is rebuilt from scratch each cycle:
+//! a counting sort of the items by cell, split across a thread pool, that leaves each cell's items side by side.
+//! Queries see the items where they were at the last rebuild. The results don't depend on the number of threads.
+//! If the world wraps, the grid is a torus and distances are measured the shorter way around.
+class MovingGrid
+{
+public:
+    MovingGrid();
+
+    void Rebuild(float const* x, float const* y, size_t const count, util::ThreadPool& threadPool);
+    size_t Nearest(float const x, float const y) const;
+    size_t Size() const;
+    float X(size_t const index) const;
+    float Y(size_t const index) const;
+
+private:
+    size_t cellOf(float const x, float const y) const;
+    void searchCell(size_t const column, size_t const row, float const x, float const y, size_t& inout_best, float& inout_bestDistanceSquared) const;
+
+    size_t m_cellsPerSide = 1;
+    float  m_cellWidth;
+    float  m_cellHeight;
+
+    std::vector<float>  m_x;            // The x-coordinate of each item at the last rebuild.
+    std::vector<float>  m_y;            // The y-coordinate of each item at the last rebuild.
+    std::vector<size_t> m_cellOfItem;   // The cell of each item.
+    std::vector<size_t> m_blockCounts;  // The number of items in each cell in each block of items, then where each block's items go. Block-major.
+    std::vector<size_t> m_cellBegin;    // Where each cell's items start in the sorted arrays. One extra at the end. Row-major.
+    std::vector<size_t> m_sortedIndex;  // The items, sorted by cell, then by index.
+    std::vector<float>  m_sortedX;      // The items' coordinates in the same order, so searching a cell reads memory front to back.
+    std::vector<float>  m_sortedY;
+};
+
+} }
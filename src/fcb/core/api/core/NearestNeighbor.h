@@ -0,0 +1,35 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <cstddef>
+
+namespace fcb { namespace core {
+
+// Brute-force nearest-neighbor search over points stored as separate x and y arrays.
+// Checks every point, 8 at a time on AVX2 builds, with the world wrap handled without branches.
+// For a few hundred points this beats walking a spatial index.
+// Distances are measured as by DistanceSquared in Geometry.h, and ties go to the lowest index, so the result is the same point a scalar search finds.
+// That relies on the build rounding every float operation as written (-ffp-contract=off, /fp:precise), which the top-level CMakeLists.txt sets.
+
+size_t NearestBruteForce(float const x, float const y, float const* pointsX, float const* pointsY, size_t const numPoints);
+void NearestBruteForce(float const* queryX, float const* queryY, size_t const numQueries,
+                       float const* pointsX, float const* pointsY, size_t const numPoints, size_t* out_nearest);
+
+} }
@@ -0,0 +1,159 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "core/CloverPool.h"
+#include "core/Fox.h"
+#include "core/MovingGrid.h"
+#include "core/SpatialGrid.h"
+#include "core/WorldSnapshot.h"
+#include "ml/Activation.h"
+#include "ml/GeneticAlgorithmPairing.h"
+#include "ml/IslandModel.h"
+#include "util/Rng.h"
+#include "util/ThreadPool.h"
+
+#include <Eigen/Dense>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fcb { namespace core {
+
+class BunnyPopulation;
+
+//! Knobs for a Simulation.
+struct SimulationSettings
+{
+    size_t numBunnies = 50;
+    size_t numClovers = 200;
+    ml::SelectionPolicy selection = ml::SelectionPolicy::Tournament(6);  // How parents are picked. For 50 bunnies, close to the old hand-tuned odds.
+    size_t numThreads = 0;  // Threads that step the bunnies, including the caller's. 0 uses one per hardware thread. Doesn't change the results.
+    ml::Activations activations;  // The activation functions of the bunnies' brains.
+    size_t numReplicas = 1;  // Worlds each generation is scored in, each with its own clover layout. Scores are averaged before ranking.
+    size_t numFoxes = 0;     // Foxes per world. They hunt the bunnies and evolve alongside them. 0 leaves the world to the bunnies and clovers.
+    uint64_t seed = util::RngGlobalInstance().GetSeed();  // Every random number in the run comes from this. The same seed gives the same run.
+};
+
+//! Runs the game world and the genetic algorithm that trains it.
+//! Has no dependency on the GUI or graphics, so it can be stepped headless as fast as the CPU allows.
+//! A front end that wants to display the world can copy it out with TakeSnapshot.
+class Simulation
+{
+public:
+    //! A copy of one bunny's genes and score, for moving it between simulations.
+    struct Individual
+    {
+        Eigen::VectorXf genome;
+        unsigned numCloversEaten;
+    };
+
+    explicit Simulation(SimulationSettings const& settings = SimulationSettings());
+
+    Simulation(Simulation const&)            = delete;
+    Simulation(Simulation&&)                 = delete;
+    Simulation& operator=(Simulation const&) = delete;
+    Simulation& operator=(Simulation&&)      = delete;
+
+    void Cycle();
+    void RunGeneration();
+    std::vector<size_t> Rank() const;
+    unsigned FoxTopScore() const;
+    unsigned NextGeneration();
+
+    bool SaveCheckpoint(std::string const& path) const;
+    bool LoadCheckpoint(std::string const& path);
+
+    Individual Emigrate(size_t const index) const;
+    void Immigrate(size_t const index, Individual const& individual);
+
+    void TakeSnapshot(WorldSnapshot& out_snapshot) const;
+
+    unsigned Generation() const;
+    uint64_t Seed() const;
+    size_t NumFoxes() const;
+    static unsigned CyclesPerGeneration();
+
+private:
+    //! One world the bunnies are scored in: the clovers, a copy of the bunnies, and scratch space for stepping them.
+    struct World
+    {
+        World(util::Philox4x32 const& rng, size_t const numClovers)
+            : cloverRng(rng)
+            , clovers(numClovers)
+            , cloverGrid(SpatialGrid::CellsPerSideFor(numClovers))
+        {
+            cloverGrid.Reserve(numClovers);
+        }
+
+        util::Philox4x32 cloverRng;  // Clovers, and bunnies that get caught, respawn one at a time in a fixed order, so they can share one stream.
+        CloverPool clovers;
+        SpatialGrid cloverGrid;  // Indexes clovers by position.
+        std::shared_ptr<BunnyPopulation> bunnies;
+        std::vector<Fox> foxes;
+        MovingGrid bunnyGrid;    // Indexes the bunnies by where they were at the start of the cycle, for the foxes. Only built when there are foxes.
+
+        // Per-cycle scratch space, kept to avoid reallocating every cycle.
+        std::vector<size_t> nearestClover;  // The index of each bunny's nearest clover.
+        std::vector<float>  targetX;        // The position of each bunny's nearest clover.
+        std::vector<float>  targetY;
+        std::vector<size_t> nearestBunny;   // The index of each fox's nearest bunny.
+    };
+
+    World& world(size_t const index);
+    template <typename Function>
+    void forEachWorld(size_t const countPerWorld, size_t const grainSize, Function&& function);
+    void step(World& world, size_t const begin, size_t const end);
+    void stepFoxes(World& world, size_t const begin, size_t const end);
+    void eat(World& world);
+    void hunt(World& world);
+    void breedFoxes();
+    void cloneReplicas();
+    void foldReplicaScores();
+    void rank(std::vector<size_t>& out_ranked) const;
+    void rankFoxes(std::vector<size_t>& out_ranked) const;
+
+    void spawnClover(World& world);
+    static void respawnClover(World& world, size_t const index);
+    std::shared_ptr<BunnyPopulation> makeBunnies(size_t const size, unsigned const generation);
+    void placeBunnies(BunnyPopulation& bunnies, unsigned const generation) const;
+    void placeFoxes(std::vector<Fox>& foxes, unsigned const generation) const;
+
+    uint64_t m_seed;
+    ml::SelectionPolicy m_selection;
+    ml::AliasTable m_parents;       // m_selection's odds for each rank. Only depends on the number of bunnies, so it's built once.
+    ml::AliasTable m_foxParents;    // The same for the foxes.
+    ml::Activations m_activations;
+    World m_world;                  // The world snapshots and checkpoints see. Its bunnies are the ones that breed.
+    std::vector<World> m_replicas;  // The other worlds. Cloned from m_world at the start of each generation.
+    unsigned m_generation = 0;
+    unsigned m_cycle = 0;           // Cycles run so far in the current generation.
+    std::vector<size_t> m_ranked;   // Scratch space for NextGeneration, kept to avoid reallocating every generation.
+    std::vector<size_t> m_children;
+    std::vector<Fox> m_nextFoxes;   // The foxes breed into these, then they swap with the main world's.
+    std::vector<size_t> m_foxRanked;
+    std::vector<size_t> m_foxChildren;
+    util::ThreadPool m_threadPool;
+};
+
+//! Several simulations evolving side by side, trading their best bunnies now and then. See ml::IslandModel.
+using Archipelago = ml::IslandModel<Simulation>;
+
+} }
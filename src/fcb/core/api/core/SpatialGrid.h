@@ -0,0 +1,62 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace fcb { namespace core {
+
+//! A uniform grid over the world bounds for nearest-neighbor queries.
+//! Items are identified by an index chosen by the owner (e.g. an index into a collection of clovers).
+//! The grid keeps its own copy of each item's position, so it must be told when an item moves.
+//! If the world wraps, the grid is a torus and distances are measured the shorter way around.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(size_t const cellsPerSide);
+
+    static size_t CellsPerSideFor(size_t const numItems);
+
+    void Reserve(size_t const numItems);
+    void Insert(size_t const index, float const x, float const y);
+    void Move(size_t const index, float const x, float const y);
+    void Clear();
+    size_t Nearest(float const x, float const y) const;
+    void Nearest(float const* x, float const* y, size_t const count, size_t* out_nearest) const;
+    size_t Size() const;
+
+private:
+    size_t cellColumn(float const x) const;
+    size_t cellRow(float const y) const;
+    void searchCell(size_t const column, size_t const row, float const x, float const y, size_t& inout_best, float& inout_bestDistanceSquared) const;
+    size_t nearestLinear(float const x, float const y) const;
+
+    size_t m_cellsPerSide;
+    float  m_cellWidth;
+    float  m_cellHeight;
+
+    std::vector<std::vector<size_t>> m_cells;  // The item indexes in each cell. Row-major.
+    std::vector<float>  m_x;                   // The x-coordinate of each item.
+    std::vector<float>  m_y;                   // The y-coordinate of each item.
+    std::vector<size_t> m_cellOf;              // The cell that holds each item.
+    std::vector<size_t> m_slotOf;              // Where each item is in its cell, for O(1) removal.
+};
+
+} }
@@ -18,31 +18,27 @@
 
 #pragma once
 
-#include "core/GameObject.h"
-#include "ml/NeuralNet.h"
+#include <vector>
 
 namespace fcb { namespace core {
 
-class Clover;
-
-//! Holds the game state for a bunny.
-class Bunny : public GameObject
+//! A copy of what is needed to draw the world at one moment.
+//! The simulation fills one in between cycles. A renderer on another thread can then draw it while the simulation moves on.
+struct WorldSnapshot
 {
-public:
-    Bunny();
-
-    unsigned  NumCloversEaten() const;
-    unsigned& NumCloversEaten();
-    void Think(Clover const& nearestClover);
-    void Act();
-
-    static void Crossover(Bunny const& m, Bunny const& f, Bunny& out_c);
-
-private:
-    unsigned m_numCloversEaten = 0;
-    float m_speed = .0028f;
-    fcb::ml::NeuralNet m_brain;
-    fcb::ml::NeuralNet::OutputType m_outputs;
+    //! Where an object is, and how big.
+    struct Pose
+    {
+        float x;
+        float y;
+        float angle;
+        float radius;
+    };
+
+    std::vector<Pose> clovers;
+    std::vector<Pose> bunnies;
+    std::vector<Pose> foxes;
+    unsigned generation = 0;
 };
 
 } }
@@ -0,0 +1,316 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "core/BunnyPopulation.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "util/BinaryIO.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace fcb::ml;
+
+namespace fcb { namespace core {
+
+
+//! Constructor.
+//! All bunnies start at the origin facing angle 0, with blank brains. See RandomizeBrain and Crossover.
+//! @param[in] size The number of bunnies.
+BunnyPopulation::BunnyPopulation(size_t const size)
+    : m_x(size, 0)
+    , m_y(size, 0)
+    , m_angle(size, 0)
+    , m_radius(size, 0.02f)
+    , m_numCloversEaten(size, 0)
+    , m_inputs(size)
+    , m_outputs(NeuralNetPopulation::OutputBatchType::Zero(static_cast<Eigen::Index>(size), NeuralNet::NUM_OUTPUTS))
+    , m_brains(size, Globals::c_numHiddenNodes)
+    , m_hidden(m_brains.HiddenBatch())
+{ }
+
+//! @return The number of bunnies.
+size_t BunnyPopulation::Size() const
+{
+    return m_x.size();
+}
+
+//! @return The x coordinate of a bunny.
+float BunnyPopulation::X(size_t const index) const
+{
+    return m_x[index];
+}
+//! @return A modifiable reference to the x coordinate of a bunny.
+float& BunnyPopulation::X(size_t const index)
+{
+    return m_x[index];
+}
+
+//! @return The y coordinate of a bunny.
+float BunnyPopulation::Y(size_t const index) const
+{
+    return m_y[index];
+}
+//! @return A modifiable reference to the y coordinate of a bunny.
+float& BunnyPopulation::Y(size_t const index)
+{
+    return m_y[index];
+}
+
+//! @return The orientation of a bunny in radians. Range is [-2*pi, 2*pi].
+float BunnyPopulation::Angle(size_t const index) const
+{
+    return m_angle[index];
+}
+//! @return A modifiable reference to the angle of a bunny in radians.
+float& BunnyPopulation::Angle(size_t const index)
+{
+    return m_angle[index];
+}
+
+//! @return The radius of a bunny's circular hitbox.
+float BunnyPopulation::Radius(size_t const index) const
+{
+    return m_radius[index];
+}
+//! @return A modifiable reference to the radius of a bunny's hitbox.
+float& BunnyPopulation::Radius(size_t const index)
+{
+    return m_radius[index];
+}
+
+//! @return The number of clovers a bunny has eaten.
+unsigned BunnyPopulation::NumCloversEaten(size_t const index) const
+{
+    return m_numCloversEaten[index];
+}
+//! @return A modifiable reference to the number of clovers a bunny has eaten.
+unsigned& BunnyPopulation::NumCloversEaten(size_t const index)
+{
+    return m_numCloversEaten[index];
+}
+
+//! Activate every bunny's brain, converting inputs to outputs.
+//! Each brain sees the bunny's look-at vector and the normalized vector to its target. The inputs are gathered for the whole population,
+//! then fed forward as one batch.
+//! @param[in] targetX The x coordinate of each bunny's nearest clover. One per bunny.
+//! @param[in] targetY The y coordinate of each bunny's nearest clover. One per bunny.
+void BunnyPopulation::Think(std::vector<float> const& targetX, std::vector<float> const& targetY)
+{
+    Think(targetX, targetY, 0, Size());
+}
+
+//! Activate the brains of the bunnies [begin, end).
+//! Only touches those bunnies, so disjoint ranges can run on different threads. Doesn't allocate.
+//! @param[in] targetX The x coordinate of each bunny's nearest clover. One per bunny.
+//! @param[in] targetY The y coordinate of each bunny's nearest clover. One per bunny.
+//! @param[in] begin   The first bunny.
+//! @param[in] end     One past the last bunny.
+void BunnyPopulation::Think(std::vector<float> const& targetX, std::vector<float> const& targetY, size_t const begin, size_t const end)
+{
+    assert(targetX.size() == Size() && targetY.size() == Size());
+    assert(begin <= end && end <= Size());
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        // Set inputs 0 and 1 to the bunny's normalized look-at vector.
+        m_inputs(i, 0) = cosf(m_angle[i]);
+        m_inputs(i, 1) = sinf(m_angle[i]);
+
+        // Set inputs 2 and 3 to the normalized vector to the target.
+        float const dx = DeltaX(m_x[i], targetX[i]);
+        float const dy = DeltaY(m_y[i], targetY[i]);
+        float const distance = sqrtf(dx * dx + dy * dy);
+        m_inputs(i, 2) = (distance == 0) ? 0 : dx / distance;
+        m_inputs(i, 3) = (distance == 0) ? 0 : dy / distance;
+    }
+
+    m_brains.FeedForward(m_inputs, m_outputs, m_hidden, begin, end);
+}
+
+//! Move every bunny based on its outputs.
+void BunnyPopulation::Act()
+{
+    Act(0, Size());
+}
+
+//! Move the bunnies [begin, end) based on their outputs.
+//! @param[in] begin The first bunny.
+//! @param[in] end   One past the last bunny.
+void BunnyPopulation::Act(size_t const begin, size_t const end)
+{
+    assert(begin <= end && end <= Size());
+    for (size_t i = begin; i < end; ++i)
+    {
+        auto const row = static_cast<Eigen::Index>(i);
+        float const leftForce  = (m_outputs(row, 0)) * m_speed;
+        float const rightForce = (m_outputs(row, 1)) * m_speed;
+
+        float const rotateBy = (leftForce - rightForce) * 200;
+        float const speed = leftForce + rightForce;
+
+        // Rotate.
+        float angle = m_angle[i] + rotateBy;
+        if (angle > static_cast<float>(2 * M_PI))
+            angle -= static_cast<float>(2 * M_PI);
+        else if (angle < static_cast<float>(-2 * M_PI))
+            angle += static_cast<float>(2 * M_PI);
+        m_angle[i] = angle;
+
+        // Move forward.
+        m_x[i] += cosf(angle) * speed;
+        m_y[i] += sinf(angle) * speed;
+    }
+}
+
+//! Keep every bunny inside the world bounds.
+void BunnyPopulation::EnforceBounds()
+{
+    EnforceBounds(0, Size());
+}
+
+//! Keep the bunnies [begin, end) inside the world bounds.
+//! @param[in] begin The first bunny.
+//! @param[in] end   One past the last bunny.
+void BunnyPopulation::EnforceBounds(size_t const begin, size_t const end)
+{
+    assert(begin <= end && end <= Size());
+    for (size_t i = begin; i < end; ++i)
+        core::EnforceBounds(m_x[i], m_y[i]);
+}
+
+//! @return A copy of a bunny's brain weights.
+//! @param[in] index Index of the bunny.
+Eigen::VectorXf BunnyPopulation::Genome(size_t const index) const
+{
+    return m_brains.Genome(index);
+}
+
+//! Replace a bunny's brain weights.
+//! @param[in] index  Index of the bunny.
+//! @param[in] genome The weights, as returned by Genome.
+void BunnyPopulation::SetGenome(size_t const index, Eigen::VectorXf const& genome)
+{
+    m_brains.SetGenome(index, genome);
+}
+
+//! Give a bunny a new random brain.
+//! @param[in] index Index of the bunny.
+//! @param[in] rng   The random number generator to draw from.
+void BunnyPopulation::RandomizeBrain(size_t const index, util::Philox4x32& rng)
+{
+    m_brains.Randomize(index, rng);
+}
+
+//! @return The activation functions of every bunny's brain.
+ml::Activations BunnyPopulation::GetActivations() const
+{
+    return m_brains.GetActivations();
+}
+
+//! Change the activation functions of every bunny's brain. Doesn't touch the weights.
+//! @param[in] activations The functions.
+void BunnyPopulation::SetActivations(ml::Activations const activations)
+{
+    m_brains.SetActivations(activations);
+}
+
+namespace {
+
+    //! Write one property array, aligned.
+    template <typename T>
+    void saveArray(std::ostream& out, std::vector<T> const& values)
+    {
+        util::WritePadding(out);
+        util::WriteRaw(out, values.data(), values.size());
+    }
+
+    //! Read one property array written by saveArray.
+    template <typename T>
+    bool loadArray(std::istream& in, std::vector<T>& out_values, size_t const size)
+    {
+        if (!util::SkipPadding(in) || !util::CanRead<T>(in, size))
+            return false;
+        out_values.resize(size);
+        return util::ReadRaw(in, out_values.data(), size);
+    }
+
+}  // Anonymous namespace.
+
+//! Write every bunny's state and brain to a binary stream. Each property is one aligned array.
+//! @param[in] out The stream. Should be opened in binary mode.
+void BunnyPopulation::Save(std::ostream& out) const
+{
+    util::WriteRaw(out, uint64_t(Size()));
+    saveArray(out, m_x);
+    saveArray(out, m_y);
+    saveArray(out, m_angle);
+    saveArray(out, m_radius);
+    saveArray(out, m_numCloversEaten);
+    util::WritePadding(out);
+    m_brains.Save(out);
+}
+
+//! Replace the whole population with one written by Save. The population takes its size from the stream.
+//! @param[in] in The stream. Should be opened in binary mode.
+//! @return false if the stream is truncated or doesn't match. The population is unchanged on failure.
+bool BunnyPopulation::Load(std::istream& in)
+{
+    uint64_t size = 0;
+    if (!util::ReadRaw(in, size))
+        return false;
+
+    BunnyPopulation loaded(0);
+    auto const count = static_cast<size_t>(size);
+    if (!loadArray(in, loaded.m_x, count) || !loadArray(in, loaded.m_y, count) || !loadArray(in, loaded.m_angle, count)
+        || !loadArray(in, loaded.m_radius, count) || !loadArray(in, loaded.m_numCloversEaten, count)
+        || !util::SkipPadding(in) || !loaded.m_brains.Load(in) || loaded.m_brains.Size() != count)
+        return false;
+    loaded.m_inputs.Resize(count);
+    loaded.m_outputs.setZero(static_cast<Eigen::Index>(count), Eigen::NoChange);
+    loaded.m_hidden = loaded.m_brains.HiddenBatch();
+
+    *this = std::move(loaded);
+    return true;
+}
+
+//! Perform gene crossover. Combine m and f and store the offspring genes for the next generation.
+//! The current brains are untouched until NextGeneration, so every bunny can still be picked as a parent.
+//! @param[in] m   Index of a bunny.
+//! @param[in] f   Index of a bunny. Can be the same as m.
+//! @param[in] c   Index of the offspring in the next generation.
+//! @param[in] rng The random number generator to draw from.
+void BunnyPopulation::BreedChild(size_t const m, size_t const f, size_t const c, util::Philox4x32& rng)
+{
+    m_brains.BreedChild(m, f, c, rng);
+}
+
+//! Replace every bunny with its offspring: swap in the bred brains and clear the scores.
+//! Doesn't allocate. Positions and angles are left as they were, for the caller to respawn the bunnies.
+void BunnyPopulation::NextGeneration()
+{
+    m_brains.NextGeneration();
+    std::fill(m_numCloversEaten.begin(), m_numCloversEaten.end(), 0u);
+}
+
+
+} }
@@ -35,6 +35,11 @@ unsigned Clover::Hp() const
 {
     return m_hp;
 }
+//! @return A modifiable reference to the clover's HP.
+unsigned& Clover::Hp()
+{
+    return m_hp;
+}
 
 //! Remove 1 HP from the clover.
 //! @return false if the clover's HP was 0 before the bite.
@@ -46,5 +51,15 @@ bool Clover::Bite()
     return true;
 }
 
+//! Bring the clover back to life in place: move it and restore its HP.
+//! @param[in] x The new x-coordinate.
+//! @param[in] y The new y-coordinate.
+void Clover::Respawn(float const x, float const y)
+{
+    this->X() = x;
+    this->Y() = y;
+    m_hp = Globals::c_cloverHp;
+}
+
 
 } }
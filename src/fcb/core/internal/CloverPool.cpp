@@ -0,0 +1,86 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "core/CloverPool.h"
+
+#include <cassert>
+
+namespace fcb { namespace core {
+
+
+//! Constructor. Allocates room for every clover. The pool starts empty.
+//! @param[in] capacity The most clovers the pool can hold.
+CloverPool::CloverPool(size_t const capacity)
+{
+    m_clovers.reserve(capacity);
+}
+
+//! @return The number of clovers spawned so far.
+size_t CloverPool::Size() const
+{
+    return m_clovers.size();
+}
+
+//! @return The most clovers the pool can hold.
+size_t CloverPool::Capacity() const
+{
+    return m_clovers.capacity();
+}
+
+//! @param[in] index The index of a spawned clover.
+Clover const& CloverPool::operator[](size_t const index) const
+{
+    assert(index < Size());
+    return m_clovers[index];
+}
+
+//! @param[in] index The index of a spawned clover.
+Clover& CloverPool::operator[](size_t const index)
+{
+    assert(index < Size());
+    return m_clovers[index];
+}
+
+//! Add a clover with full HP. The pool must not be full.
+//! @param[in] x The clover's x-coordinate.
+//! @param[in] y The clover's y-coordinate.
+//! @return The new clover's index.
+size_t CloverPool::Spawn(float const x, float const y)
+{
+    if (Size() == Capacity())
+    {
+        assert(false);
+        return Size() - 1;
+    }
+
+    m_clovers.emplace_back();
+    Respawn(Size() - 1, x, y);
+    return Size() - 1;
+}
+
+//! Bring a clover back at a new spot with full HP. The same object, in the same place.
+//! @param[in] index The index of a spawned clover.
+//! @param[in] x     The clover's new x-coordinate.
+//! @param[in] y     The clover's new y-coordinate.
+void CloverPool::Respawn(size_t const index, float const x, float const y)
+{
+    m_clovers[index].Respawn(x, y);
+}
+
+
+} }
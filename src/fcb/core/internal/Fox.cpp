@@ -18,18 +18,15 @@
 
 #include "core/Fox.h"
 
-#include "core/Bunny.h"
+#include "core/Geometry.h"
 #include "core/Globals.h"
 
 #include <Eigen/Dense>
 
-using namespace fcb::ml;
-
 namespace fcb { namespace core {
 
 
 Fox::Fox()
-    : m_brain(Globals::c_numHiddenNodes)
 {
     this->Radius() = 0.03f;
 }
@@ -46,14 +43,19 @@ unsigned& Fox::NumBunniesEaten()
 }
 
 //! Activate the brain, converting inputs to outputs.
-//! @param[in] nearestBunny The nearest bunny to the fox.
-void Fox::Think(Bunny const& nearestBunny)
+//! @param[in] targetX The x-coordinate of the nearest bunny.
+//! @param[in] targetY The y-coordinate of the nearest bunny.
+void Fox::Think(float const targetX, float const targetY)
 {
-    NeuralNet::InputType inputs;
+    Brain::InputType inputs;
     // Set inputs 0 and 1 to this object's normalized look-at vector.
     this->GetLookAtVector(inputs(0), inputs(1));
     // Set inputs 2 and 3 to the normalized vector to the target.
-    this->CalcVectorTo(nearestBunny, inputs(2), inputs(3));
+    float const dx = DeltaX(this->X(), targetX);
+    float const dy = DeltaY(this->Y(), targetY);
+    float const distance = sqrtf(dx * dx + dy * dy);
+    inputs(2) = (distance == 0) ? 0 : dx / distance;
+    inputs(3) = (distance == 0) ? 0 : dy / distance;
 
     m_brain.FeedForward(inputs, m_outputs);
 }
@@ -71,13 +73,34 @@ void Fox::Act()
     this->MoveForward(speed);
 }
 
+//! Set the brain's weights randomly.
+//! @param[in] rng The random number generator to draw from.
+void Fox::RandomizeBrain(util::Philox4x32& rng)
+{
+    m_brain.Randomize(rng);
+}
+
+//! @return A copy of the brain's weights.
+Eigen::VectorXf Fox::Genome() const
+{
+    return m_brain.Genome();
+}
+
+//! Overwrite the brain's weights.
+//! @param[in] genome The weights, as Genome returns them.
+void Fox::SetGenome(Eigen::VectorXf const& genome)
+{
+    m_brain.SetGenome(genome);
+}
+
 //! Perform gene crossover. Combine m and f and output offspring genes.
 //! @param[in]  m     A fox.
 //! @param[in]  f     A fox. Can be the same as m.
 //! @param[out] out_c A fox instance into which to store the offspring.
-void Fox::Crossover(Fox const& m, Fox const& f, Fox& out_c)
+//! @param[in]  rng   The random number generator to draw from.
+void Fox::Crossover(Fox const& m, Fox const& f, Fox& out_c, util::Philox4x32& rng)
 {
-    NeuralNet::Crossover(m.m_brain, f.m_brain, out_c.m_brain);
+    Brain::Crossover(m.m_brain, f.m_brain, out_c.m_brain, rng);
 }
 
 
@@ -18,6 +18,8 @@
 
 #include "core/GameObject.h"
 
+#include "core/Geometry.h"
+
 namespace fcb { namespace core {
 
 
@@ -112,6 +114,7 @@ void GameObject::SetLookAtVector(float const x, float const y)
 }
 
 // Given another object, calculate the normalized vector between them.
+// If the world wraps, the vector points the shorter way around the world.
 //! @param[in]  other The other object to calculate the vector to.
 //! @param[out] out_x Will be set to the normalized x component of the vector from this object to the other.
 //! @param[out] out_y Will be set to the normalized y component of the vector from this object to the other.
@@ -125,13 +128,13 @@ void GameObject::CalcVectorTo(GameObject const& other, float& out_x, float& out_
     }
     else
     {
-        out_x = (other.m_x - m_x) / distance;
-        out_y = (other.m_y - m_y) / distance;
+        out_x = DeltaX(m_x, other.m_x) / distance;
+        out_y = DeltaY(m_y, other.m_y) / distance;
     }
 }
 
 //! @param[in] other Another class instance.
-//! @return The euclidean distance from this object to the other.
+//! @return The euclidean distance from this object to the other. If the world wraps, this is the shorter way around.
 float GameObject::Distance(GameObject const& other) const
 {
     return sqrtf(DistanceSquared(other));
@@ -144,7 +147,7 @@ float GameObject::Distance(GameObject const& other) const
 //! @return The square of the euclidean distance from this object to the other.
 float GameObject::DistanceSquared(GameObject const& other) const
 {
-    return (m_x - other.m_x) * (m_x - other.m_x) + (m_y - other.m_y) * (m_y - other.m_y);
+    return core::DistanceSquared(m_x, m_y, other.m_x, other.m_y);
 }
 
 //! Checks if another object is within a given distance.
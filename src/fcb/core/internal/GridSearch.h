@@ -0,0 +1,115 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "core/Globals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// The cell math and the ring search shared by SpatialGrid and MovingGrid. The grids differ only in how a cell stores its items.
+
+namespace fcb { namespace core {
+
+//! Convert a world coordinate to a cell coordinate, clamped to the grid.
+inline size_t ToGridCell(float const coordinate, float const lowerBound, float const cellSize, size_t const cellsPerSide)
+{
+    float const cell = std::floor((coordinate - lowerBound) / cellSize);
+    if (cell <= 0)
+        return 0;
+    return std::min(static_cast<size_t>(cell), cellsPerSide - 1);
+}
+
+//! Find the item nearest to a point in a grid that covers the world.
+//! Searches rings of cells outward from the point's cell and stops once no unsearched cell can hold anything closer.
+//! @param[in] cellsPerSide The number of cells along each axis.
+//! @param[in] cellWidth    The width of a cell.
+//! @param[in] cellHeight   The height of a cell.
+//! @param[in] homeColumn   The column of the point's cell.
+//! @param[in] homeRow      The row of the point's cell.
+//! @param[in] searchCell   Called as searchCell(column, row, inout_best, inout_bestDistanceSquared) to check the items in one cell
+//!                         against the best candidate so far.
+//! @param[in] bruteForce   Called with no arguments once the grid is too sparse to help. Returns the nearest item by checking every one.
+//! @return The index of the nearest item.
+template <typename SearchCell, typename BruteForce>
+size_t NearestInGrid(size_t const cellsPerSide, float const cellWidth, float const cellHeight, size_t const homeColumn, size_t const homeRow,
+                     SearchCell&& searchCell, BruteForce&& bruteForce)
+{
+    auto const n = static_cast<std::ptrdiff_t>(cellsPerSide);
+    auto const column0 = static_cast<std::ptrdiff_t>(homeColumn);
+    auto const row0    = static_cast<std::ptrdiff_t>(homeRow);
+    float const minCellSize = std::min(cellWidth, cellHeight);
+    // Far more than the few ulps of a world coordinate that rounding can move an item by, and far less than a cell.
+    float const roundingMargin = 1e-5f * (Globals::c_worldRightBound - Globals::c_worldLeftBound);
+
+    size_t best = 0;
+    float bestDistanceSquared = std::numeric_limits<float>::infinity();
+
+    // Searches one cell, wrapping or skipping cell coordinates that fall off the grid.
+    auto const visit = [&](std::ptrdiff_t column, std::ptrdiff_t row) {
+        if constexpr (Globals::c_worldWrap)
+        {
+            column = (column % n + n) % n;
+            row    = (row    % n + n) % n;
+        }
+        else if (column < 0 || column >= n || row < 0 || row >= n)
+        {
+            return;
+        }
+        searchCell(static_cast<size_t>(column), static_cast<size_t>(row), best, bestDistanceSquared);
+    };
+
+    for (std::ptrdiff_t ring = 0; ring < n; ++ring)
+    {
+        // Once a ring would wrap around onto itself, the grid is too sparse to help.
+        if (2 * ring + 1 > n && Globals::c_worldWrap)
+            return bruteForce();
+
+        if (ring == 0)
+        {
+            visit(column0, row0);
+        }
+        else
+        {
+            // Top and bottom edges of the ring, then the left and right sides.
+            for (std::ptrdiff_t dx = -ring; dx <= ring; ++dx)
+            {
+                visit(column0 + dx, row0 - ring);
+                visit(column0 + dx, row0 + ring);
+            }
+            for (std::ptrdiff_t dy = -ring + 1; dy <= ring - 1; ++dy)
+            {
+                visit(column0 - ring, row0 + dy);
+                visit(column0 + ring, row0 + dy);
+            }
+        }
+
+        // Anything outside this ring is at least `ring` whole cells away, give or take the rounding in ToGridCell and DistanceSquared.
+        // An item that far out can tie the best and still have a lower index, so only a best clearly inside the ring ends the search.
+        float const searchedRadius = static_cast<float>(ring) * minCellSize - roundingMargin;
+        if (searchedRadius > 0 && bestDistanceSquared < searchedRadius * searchedRadius)
+            return best;
+    }
+
+    return best;
+}
+
+} }
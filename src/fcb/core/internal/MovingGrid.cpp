@@ -0,0 +1,188 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "core/MovingGrid.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "core/NearestNeighbor.h"
+#include "core/SpatialGrid.h"
+
+#include "GridSearch.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace fcb { namespace core {
+
+namespace {
+
+    // Fewer items than this aren't worth waking another thread for.
+    size_t constexpr c_minItemsPerBlock = 4096;
+
+}  // Anonymous namespace.
+
+
+//! Constructor. The grid is empty until the first Rebuild.
+MovingGrid::MovingGrid()
+    : m_cellWidth(Globals::c_worldRightBound - Globals::c_worldLeftBound)
+    , m_cellHeight(Globals::c_worldTopBound - Globals::c_worldBottomBound)
+    , m_cellBegin(2, 0)
+{ }
+
+//! Replace the items with a new set of positions. Item i is at (x[i], y[i]).
+//! A counting sort in two passes over the items, each split into blocks across the thread pool: count the items in each cell per block,
+//! then, after a prefix sum over the counts, put each item in its place. Each block's items go after the earlier blocks' items in the same cell,
+//! so the order is the same however the items were split. Doesn't allocate after the first rebuild at a given size.
+//! Must not be called from inside a job on the same thread pool.
+//! @param[in] x          The x-coordinate of each item.
+//! @param[in] y          The y-coordinate of each item.
+//! @param[in] count      The number of items.
+//! @param[in] threadPool Where to run the passes.
+void MovingGrid::Rebuild(float const* x, float const* y, size_t const count, util::ThreadPool& threadPool)
+{
+    // The resolution follows the number of items.
+    size_t const cellsPerSide = SpatialGrid::CellsPerSideFor(count);
+    size_t const numCells = cellsPerSide * cellsPerSide;
+    if (cellsPerSide != m_cellsPerSide)
+    {
+        m_cellsPerSide = cellsPerSide;
+        m_cellWidth  = (Globals::c_worldRightBound - Globals::c_worldLeftBound) / static_cast<float>(m_cellsPerSide);
+        m_cellHeight = (Globals::c_worldTopBound - Globals::c_worldBottomBound) / static_cast<float>(m_cellsPerSide);
+    }
+    m_cellBegin.resize(numCells + 1);
+
+    m_x.resize(count);
+    m_y.resize(count);
+    m_cellOfItem.resize(count);
+    m_sortedIndex.resize(count);
+    m_sortedX.resize(count);
+    m_sortedY.resize(count);
+
+    size_t const numBlocks = std::min(threadPool.NumThreads(), count / c_minItemsPerBlock + 1);
+    auto const blockBegin = [count, numBlocks](size_t const block) { return count * block / numBlocks; };
+    m_blockCounts.assign(numBlocks * numCells, 0);
+
+    // Count.
+    threadPool.ParallelFor(numBlocks, 1, [&](size_t const first, size_t const last) {
+        for (size_t block = first; block < last; ++block)
+        {
+            size_t* const counts = &m_blockCounts[block * numCells];
+            for (size_t i = blockBegin(block); i < blockBegin(block + 1); ++i)
+            {
+                size_t const cell = cellOf(x[i], y[i]);
+                m_x[i] = x[i];
+                m_y[i] = y[i];
+                m_cellOfItem[i] = cell;
+                ++counts[cell];
+            }
+        }
+    });
+
+    // Turn the counts into where each block's items in each cell start.
+    size_t offset = 0;
+    for (size_t cell = 0; cell < numCells; ++cell)
+    {
+        m_cellBegin[cell] = offset;
+        for (size_t block = 0; block < numBlocks; ++block)
+        {
+            size_t& slot = m_blockCounts[block * numCells + cell];
+            size_t const blockCount = slot;
+            slot = offset;
+            offset += blockCount;
+        }
+    }
+    m_cellBegin[numCells] = offset;
+
+    // Place.
+    threadPool.ParallelFor(numBlocks, 1, [&](size_t const first, size_t const last) {
+        for (size_t block = first; block < last; ++block)
+        {
+            size_t* const next = &m_blockCounts[block * numCells];
+            for (size_t i = blockBegin(block); i < blockBegin(block + 1); ++i)
+            {
+                size_t const slot = next[m_cellOfItem[i]]++;
+                m_sortedIndex[slot] = i;
+                m_sortedX[slot] = m_x[i];
+                m_sortedY[slot] = m_y[i];
+            }
+        }
+    });
+}
+
+//! Find the item nearest to a point, as of the last rebuild.
+//! Searches rings of cells outward from the point's cell and stops once no unsearched cell can hold anything closer.
+//! Ties go to the lowest index. The grid must not be empty.
+//! @param[in] x The x-coordinate of the point.
+//! @param[in] y The y-coordinate of the point.
+//! @return The index of the nearest item.
+size_t MovingGrid::Nearest(float const x, float const y) const
+{
+    assert(Size() > 0);
+
+    size_t const home = cellOf(x, y);
+    return NearestInGrid(m_cellsPerSide, m_cellWidth, m_cellHeight, home % m_cellsPerSide, home / m_cellsPerSide,
+        [&](size_t const column, size_t const row, size_t& inout_best, float& inout_bestDistanceSquared) {
+            searchCell(column, row, x, y, inout_best, inout_bestDistanceSquared);
+        },
+        [&] { return NearestBruteForce(x, y, m_x.data(), m_y.data(), Size()); });
+}
+
+//! @return The number of items as of the last rebuild.
+size_t MovingGrid::Size() const
+{
+    return m_x.size();
+}
+
+//! @return The x-coordinate of an item as of the last rebuild.
+float MovingGrid::X(size_t const index) const
+{
+    return m_x[index];
+}
+
+//! @return The y-coordinate of an item as of the last rebuild.
+float MovingGrid::Y(size_t const index) const
+{
+    return m_y[index];
+}
+
+size_t MovingGrid::cellOf(float const x, float const y) const
+{
+    size_t const column = ToGridCell(x, Globals::c_worldLeftBound, m_cellWidth, m_cellsPerSide);
+    size_t const row    = ToGridCell(y, Globals::c_worldBottomBound, m_cellHeight, m_cellsPerSide);
+    return row * m_cellsPerSide + column;
+}
+
+//! Check the items in one cell against the best candidate so far.
+void MovingGrid::searchCell(size_t const column, size_t const row, float const x, float const y, size_t& inout_best, float& inout_bestDistanceSquared) const
+{
+    size_t const cell = row * m_cellsPerSide + column;
+    for (size_t slot = m_cellBegin[cell]; slot < m_cellBegin[cell + 1]; ++slot)
+    {
+        float const distanceSquared = DistanceSquared(x, y, m_sortedX[slot], m_sortedY[slot]);
+        size_t const index = m_sortedIndex[slot];
+        if (distanceSquared < inout_bestDistanceSquared || (distanceSquared == inout_bestDistanceSquared && index < inout_best))
+        {
+            inout_bestDistanceSquared = distanceSquared;
+            inout_best = index;
+        }
+    }
+}
+
+
+} }
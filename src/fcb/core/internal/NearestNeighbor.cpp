@@ -0,0 +1,258 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "core/NearestNeighbor.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace fcb { namespace core {
+
+
+namespace {
+
+    // The batched search works through a tile of queries against a tile of points at a time,
+    // so the tile of points stays in L1 while every query in the tile checks it.
+    size_t constexpr c_queryTile = 32;
+    size_t constexpr c_pointTile = 1024;  // 8 KiB of coordinates. A multiple of the vector width.
+
+    float constexpr c_worldWidth  = Globals::c_worldRightBound - Globals::c_worldLeftBound;
+    float constexpr c_worldHeight = Globals::c_worldTopBound - Globals::c_worldBottomBound;
+
+#if defined(__AVX2__)
+    size_t constexpr c_width = 8;
+    size_t constexpr c_chains = 2;  // Independent bests, so each comparison doesn't have to wait for the one before.
+
+    // Each lane remembers its own best point, as a float so it can be selected with the distances.
+    // Floats hold every integer below 2^24 exactly. Sets of 2^24 points or more take the scalar search.
+    size_t constexpr c_maxVectorPoints = size_t(1) << 24;
+
+    //! The best point so far in each lane of each chain. Every lane sees its points in index order.
+    struct Best
+    {
+        Best()
+        {
+            std::fill(distanceSquared, distanceSquared + c_chains, _mm256_set1_ps(std::numeric_limits<float>::infinity()));
+            std::fill(index, index + c_chains, _mm256_setzero_ps());
+        }
+
+        __m256 distanceSquared[c_chains];
+        __m256 index[c_chains];
+    };
+
+    //! WrapDelta, a packet at a time. Subtracts or adds the extent through masks instead of branches.
+    //! At most one of the two applies, and the other adds or subtracts exactly 0, so the result matches WrapDelta's.
+    __m256 wrapDelta(__m256 delta, float const extent)
+    {
+        if constexpr (Globals::c_worldWrap)
+        {
+            __m256 const wide  = _mm256_set1_ps(extent);
+            __m256 const over  = _mm256_and_ps(_mm256_cmp_ps(delta, _mm256_set1_ps(extent / 2), _CMP_GT_OQ), wide);
+            __m256 const under = _mm256_and_ps(_mm256_cmp_ps(delta, _mm256_set1_ps(-extent / 2), _CMP_LT_OQ), wide);
+            delta = _mm256_add_ps(_mm256_sub_ps(delta, over), under);
+        }
+        return delta;
+    }
+
+    //! Check 8 points against the best so far in one chain.
+    void check(__m256 const x, __m256 const y, __m256 const pointsX, __m256 const pointsY, __m256 const index, __m256& inout_bestDistanceSquared, __m256& inout_bestIndex)
+    {
+        __m256 const dx = wrapDelta(_mm256_sub_ps(pointsX, x), c_worldWidth);
+        __m256 const dy = wrapDelta(_mm256_sub_ps(pointsY, y), c_worldHeight);
+        __m256 const distanceSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+        // Strictly less, so each lane keeps the first of equally near points.
+        __m256 const closer = _mm256_cmp_ps(distanceSquared, inout_bestDistanceSquared, _CMP_LT_OQ);
+        inout_bestDistanceSquared = _mm256_blendv_ps(inout_bestDistanceSquared, distanceSquared, closer);
+        inout_bestIndex = _mm256_blendv_ps(inout_bestIndex, index, closer);
+    }
+
+    //! Check points [begin, end) against the best so far.
+    //! The leftover points at the end go through a packet padded with NaN, which is never closer.
+    void scan(float const x, float const y, float const* pointsX, float const* pointsY, size_t const begin, size_t const end, Best& inout_best)
+    {
+        assert(end < c_maxVectorPoints);  // Or the float indexes would round.
+        __m256 const queryX = _mm256_set1_ps(x);
+        __m256 const queryY = _mm256_set1_ps(y);
+        __m256 const step = _mm256_set1_ps(static_cast<float>(c_width));
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(begin)), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+
+        size_t i = begin;
+        for (; i + c_chains * c_width <= end; i += c_chains * c_width)
+        {
+            for (size_t chain = 0; chain < c_chains; ++chain)
+            {
+                size_t const offset = i + chain * c_width;
+                check(queryX, queryY, _mm256_loadu_ps(pointsX + offset), _mm256_loadu_ps(pointsY + offset), index, inout_best.distanceSquared[chain], inout_best.index[chain]);
+                index = _mm256_add_ps(index, step);
+            }
+        }
+        for (; i + c_width <= end; i += c_width)
+        {
+            check(queryX, queryY, _mm256_loadu_ps(pointsX + i), _mm256_loadu_ps(pointsY + i), index, inout_best.distanceSquared[0], inout_best.index[0]);
+            index = _mm256_add_ps(index, step);
+        }
+        if (i < end)
+        {
+            float tailX[c_width];
+            float tailY[c_width];
+            std::fill(tailX, tailX + c_width, std::numeric_limits<float>::quiet_NaN());
+            std::fill(tailY, tailY + c_width, std::numeric_limits<float>::quiet_NaN());
+            std::copy(pointsX + i, pointsX + end, tailX);
+            std::copy(pointsY + i, pointsY + end, tailY);
+            check(queryX, queryY, _mm256_loadu_ps(tailX), _mm256_loadu_ps(tailY), index, inout_best.distanceSquared[0], inout_best.index[0]);
+        }
+    }
+
+    //! Pick the best of the lanes. Ties go to the lowest index.
+    size_t reduce(Best const& best)
+    {
+        alignas(32) float distanceSquared[c_chains * c_width];
+        alignas(32) float index[c_chains * c_width];
+        for (size_t chain = 0; chain < c_chains; ++chain)
+        {
+            _mm256_store_ps(distanceSquared + chain * c_width, best.distanceSquared[chain]);
+            _mm256_store_ps(index + chain * c_width, best.index[chain]);
+        }
+
+        size_t lane = 0;
+        for (size_t i = 1; i < c_chains * c_width; ++i)
+        {
+            if (distanceSquared[i] < distanceSquared[lane] || (distanceSquared[i] == distanceSquared[lane] && index[i] < index[lane]))
+                lane = i;
+        }
+        return static_cast<size_t>(index[lane]);
+    }
+#else
+    size_t constexpr c_maxVectorPoints = std::numeric_limits<size_t>::max();  // The indexes are exact at any size.
+
+    //! The best point so far.
+    struct Best
+    {
+        float distanceSquared = std::numeric_limits<float>::infinity();
+        size_t index = 0;
+    };
+
+    //! Check points [begin, end) against the best so far.
+    void scan(float const x, float const y, float const* pointsX, float const* pointsY, size_t const begin, size_t const end, Best& inout_best)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            float const distanceSquared = DistanceSquared(x, y, pointsX[i], pointsY[i]);
+            if (distanceSquared < inout_best.distanceSquared)
+            {
+                inout_best.distanceSquared = distanceSquared;
+                inout_best.index = i;
+            }
+        }
+    }
+
+    size_t reduce(Best const& best)
+    {
+        return best.index;
+    }
+#endif
+
+    //! The plain loop, for sets of points too big for the vector search's indexes.
+    size_t nearestScalar(float const x, float const y, float const* pointsX, float const* pointsY, size_t const numPoints)
+    {
+        size_t best = 0;
+        float bestDistanceSquared = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            float const distanceSquared = DistanceSquared(x, y, pointsX[i], pointsY[i]);
+            if (distanceSquared < bestDistanceSquared)
+            {
+                bestDistanceSquared = distanceSquared;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+}  // Anonymous namespace.
+
+
+//! Find the point nearest to a query point by checking every point.
+//! @param[in] x         The x-coordinate of the query point.
+//! @param[in] y         The y-coordinate of the query point.
+//! @param[in] pointsX   The x-coordinate of each point.
+//! @param[in] pointsY   The y-coordinate of each point.
+//! @param[in] numPoints The number of points. Must not be 0.
+//! @return The index of the nearest point.
+size_t NearestBruteForce(float const x, float const y, float const* pointsX, float const* pointsY, size_t const numPoints)
+{
+    assert(numPoints > 0);
+    if (numPoints >= c_maxVectorPoints)
+        return nearestScalar(x, y, pointsX, pointsY, numPoints);
+
+    Best best;
+    scan(x, y, pointsX, pointsY, 0, numPoints, best);
+    return reduce(best);
+}
+
+//! Find the nearest point to each of several query points by checking every point.
+//! Works through the queries and the points in tiles, so each tile of points is read from memory once per tile of queries, not once per query.
+//! Gives the same results as searching for each query on its own.
+//! @param[in]  queryX      The x-coordinate of each query point.
+//! @param[in]  queryY      The y-coordinate of each query point.
+//! @param[in]  numQueries  The number of query points.
+//! @param[in]  pointsX     The x-coordinate of each point.
+//! @param[in]  pointsY     The y-coordinate of each point.
+//! @param[in]  numPoints   The number of points. Must not be 0.
+//! @param[out] out_nearest The index of the nearest point to each query. Must have room for numQueries.
+void NearestBruteForce(float const* queryX, float const* queryY, size_t const numQueries,
+                       float const* pointsX, float const* pointsY, size_t const numPoints, size_t* out_nearest)
+{
+    assert(numPoints > 0);
+    if (numPoints >= c_maxVectorPoints)
+    {
+        for (size_t q = 0; q < numQueries; ++q)
+            out_nearest[q] = nearestScalar(queryX[q], queryY[q], pointsX, pointsY, numPoints);
+        return;
+    }
+
+    Best best[c_queryTile];
+    for (size_t queryBegin = 0; queryBegin < numQueries; queryBegin += c_queryTile)
+    {
+        size_t const queryEnd = std::min(queryBegin + c_queryTile, numQueries);
+        std::fill(best, best + (queryEnd - queryBegin), Best());
+
+        // Each query sees the points in index order, tile after tile, so it ends up with the same best as a single scan.
+        for (size_t pointBegin = 0; pointBegin < numPoints; pointBegin += c_pointTile)
+        {
+            size_t const pointEnd = std::min(pointBegin + c_pointTile, numPoints);
+            for (size_t q = queryBegin; q < queryEnd; ++q)
+                scan(queryX[q], queryY[q], pointsX, pointsY, pointBegin, pointEnd, best[q - queryBegin]);
+        }
+
+        for (size_t q = queryBegin; q < queryEnd; ++q)
+            out_nearest[q] = reduce(best[q - queryBegin]);
+    }
+}
+
+
+} }
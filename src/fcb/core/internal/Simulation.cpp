@@ -0,0 +1,742 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "core/Simulation.h"
+
+#include "core/BunnyPopulation.h"
+#include "core/Clover.h"
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "ml/GeneticAlgorithmPairing.h"
+#include "util/BinaryIO.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+namespace fcb { namespace core {
+
+namespace {
+
+// Fewer bunnies than this aren't worth waking another thread for.
+size_t constexpr c_minBunniesPerThread = 256;
+size_t constexpr c_minFoxesPerThread   = 256;
+
+// Random number stream ids. Every use of randomness gets its own stream, keyed further by generation and agent where needed.
+uint32_t constexpr c_streamClovers     = 1;
+uint32_t constexpr c_streamBunnySpawn  = 2;
+uint32_t constexpr c_streamBunnyBrains = 3;
+uint32_t constexpr c_streamBreeding    = 4;
+uint32_t constexpr c_streamReplicas    = 5;  // Clovers in the replicas, keyed by generation and replica.
+uint32_t constexpr c_streamFoxSpawn    = 6;
+uint32_t constexpr c_streamFoxBrains   = 7;
+uint32_t constexpr c_streamFoxBreeding = 8;
+
+std::uniform_real_distribution<float> s_distPosition(-1, 1);
+std::uniform_real_distribution<float> s_distAngle(0, 2 * static_cast<float>(M_PI));
+
+// Checkpoint file format. Bump the version whenever the layout changes.
+char constexpr c_checkpointMagic[8] = "FCBCKPT";
+uint32_t constexpr c_checkpointVersion = 2;
+uint32_t constexpr c_checkpointByteOrderMark = 0x01020304;  // Reads back scrambled on a machine with the other byte order.
+
+//! The start of a checkpoint file.
+//! Followed by the clovers (count, then x, y, and HP arrays), the bunnies (see BunnyPopulation::Save),
+//! and the foxes (x, y, angle, and score arrays, then each fox's genome).
+//! Every array starts at a multiple of util::c_binaryAlignment bytes.
+struct CheckpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t seed;
+    uint32_t generation;
+    uint32_t numFoxes;
+    util::Philox4x32::State cloverRng;
+};
+
+//! Rank a population by score, best first. Ties keep index order, the same order as a stable sort,
+//! without the stable sort's temporary buffer.
+//! @param[in]  count      The size of the population.
+//! @param[in]  score      A callable that returns the score of an individual. Signature must be (size_t index) -> unsigned.
+//! @param[out] out_ranked Overwritten with the indexes of the population, best first.
+template <typename ScoreFunction>
+void rankBy(size_t const count, ScoreFunction const& score, std::vector<size_t>& out_ranked)
+{
+    out_ranked.resize(count);
+    std::iota(out_ranked.begin(), out_ranked.end(), size_t(0));
+    std::sort(out_ranked.begin(), out_ranked.end(), [&score](size_t left, size_t right) {
+        unsigned const leftScore = score(left);
+        unsigned const rightScore = score(right);
+        return leftScore != rightScore ? leftScore > rightScore : left < right;
+    });
+}
+
+}  // Anonymous namespace.
+
+
+//! Constructor. Populates the world with the first generation.
+//! @param[in] settings Optional. How to run the simulation.
+Simulation::Simulation(SimulationSettings const& settings)
+    : m_seed(settings.seed)
+    , m_selection(settings.selection)
+    , m_parents(ml::RankWeights(m_selection, settings.numBunnies))
+    , m_foxParents(ml::RankWeights(m_selection, std::max<size_t>(settings.numFoxes, 1)))
+    , m_activations(settings.activations)
+    , m_world(util::Philox4x32(m_seed, c_streamClovers), settings.numClovers)
+    , m_threadPool(settings.numThreads)
+{
+    assert(settings.numBunnies > 0 && settings.numClovers > 0 && settings.numReplicas > 0);
+
+    for (size_t i = 0; i < settings.numClovers; ++i)
+        spawnClover(m_world);
+
+    m_world.bunnies = makeBunnies(settings.numBunnies, m_generation);
+    for (size_t i = 0; i < settings.numBunnies; ++i)
+    {
+        util::Philox4x32 rng(m_seed, c_streamBunnyBrains, m_generation, static_cast<uint32_t>(i));
+        m_world.bunnies->RandomizeBrain(i, rng);
+    }
+    m_world.nearestClover.resize(settings.numBunnies);
+    m_world.targetX.resize(settings.numBunnies);
+    m_world.targetY.resize(settings.numBunnies);
+
+    m_world.foxes.resize(settings.numFoxes);
+    for (size_t i = 0; i < settings.numFoxes; ++i)
+    {
+        util::Philox4x32 rng(m_seed, c_streamFoxBrains, m_generation, static_cast<uint32_t>(i));
+        m_world.foxes[i].RandomizeBrain(rng);
+    }
+    placeFoxes(m_world.foxes, m_generation);
+    m_world.nearestBunny.resize(settings.numFoxes);
+    m_nextFoxes = m_world.foxes;
+
+    // Filled in at the start of each generation.
+    for (size_t r = 1; r < settings.numReplicas; ++r)
+        m_replicas.emplace_back(m_world.cloverRng, settings.numClovers);
+}
+
+//! Advance the world by one cycle.
+//! Every bunny finds its nearest clover, thinks, moves, and eats. Every fox finds its nearest bunny, thinks, moves, and hunts.
+//! Everything senses the world as it was at the start of the cycle.
+//! Sensing, thinking, and moving only touch the animal's own state, so they run on the thread pool, split into contiguous ranges of animals.
+//! Eating and hunting change the world, so they run afterwards in index order: one thread per replica, and this thread for the main world.
+//! The results are bit-identical no matter how many threads there are.
+void Simulation::Cycle()
+{
+    if (m_cycle == 0)
+        cloneReplicas();
+
+    // The bunnies all move every cycle, so the foxes' index of them is rebuilt from scratch.
+    if (!m_world.foxes.empty())
+    {
+        util::ScopedTimer const timer("index");
+        for (size_t index = 0; index < 1 + m_replicas.size(); ++index)
+        {
+            World& w = world(index);
+            w.bunnyGrid.Rebuild(&w.bunnies->X(0), &w.bunnies->Y(0), w.bunnies->Size(), m_threadPool);
+        }
+    }
+
+    forEachWorld(m_world.bunnies->Size(), c_minBunniesPerThread, [this](World& w, size_t const begin, size_t const end) { step(w, begin, end); });
+    forEachWorld(m_world.foxes.size(), c_minFoxesPerThread, [this](World& w, size_t const begin, size_t const end) { stepFoxes(w, begin, end); });
+
+    m_threadPool.ParallelFor(m_replicas.size(), 1, [this](size_t const begin, size_t const end) {
+        for (size_t r = begin; r < end; ++r)
+        {
+            eat(m_replicas[r]);
+            hunt(m_replicas[r]);
+        }
+    });
+    eat(m_world);
+    hunt(m_world);
+    foldReplicaScores();
+
+    ++m_cycle;
+}
+
+//! Run every cycle of the current generation, without stopping to draw.
+void Simulation::RunGeneration()
+{
+    for (unsigned numCycles = 0; numCycles < CyclesPerGeneration(); ++numCycles)
+        Cycle();
+}
+
+//! Rank the bunnies by the number of clovers eaten, summed over every world. The same order as by the average.
+//! @return The indexes of the bunnies, best first. Ties keep index order.
+std::vector<size_t> Simulation::Rank() const
+{
+    std::vector<size_t> ranked;
+    rank(ranked);
+    return ranked;
+}
+
+//! @return The most bunnies a fox has caught so far in the current generation, averaged over the worlds and rounded. 0 with no foxes.
+unsigned Simulation::FoxTopScore() const
+{
+    unsigned topScore = 0;
+    for (Fox const& fox : m_world.foxes)
+        topScore = std::max(topScore, fox.NumBunniesEaten());
+    unsigned const numWorlds = static_cast<unsigned>(1 + m_replicas.size());
+    return (topScore + numWorlds / 2) / numWorlds;
+}
+
+//! End the current generation.
+//! Ranks the bunnies, then replaces them with children bred from the best of them.
+//! @return The top score of the generation that just ended, averaged over the worlds and rounded.
+unsigned Simulation::NextGeneration()
+{
+    BunnyPopulation& bunnies = *m_world.bunnies;
+
+    rank(m_ranked);
+    unsigned const numWorlds = static_cast<unsigned>(1 + m_replicas.size());
+    unsigned const topScore = (bunnies.NumCloversEaten(m_ranked[0]) + numWorlds / 2) / numWorlds;
+
+    // Create the next generation in place. The children's brains go into the brains' second arena,
+    // so every parent stays intact until the whole generation is bred. Then the arenas flip.
+    // Nothing here allocates once the scratch space has grown to size in the first generation.
+    util::ScopedTimer const timer("breed");
+    m_children.resize(bunnies.Size());
+    std::iota(m_children.begin(), m_children.end(), size_t(0));
+
+    // Do GA breeding. Each child gets its own stream.
+    auto lRngForChild = [this](size_t const c) {
+        return util::Philox4x32(m_seed, c_streamBreeding, m_generation, static_cast<uint32_t>(c)); };
+    auto lBreedChildBunny = [&bunnies](size_t const m, size_t const f, size_t& out_c, util::Philox4x32& rng) {
+        bunnies.BreedChild(m, f, out_c, rng); };
+    ml::BreedPopChance(m_ranked, m_children, lRngForChild, lBreedChildBunny, m_parents);
+    bunnies.NextGeneration();
+    placeBunnies(bunnies, m_generation + 1);
+    if (!m_world.foxes.empty())
+        breedFoxes();
+
+    ++m_generation;
+    m_cycle = 0;
+    return topScore;
+}
+
+//! Save the whole state of the simulation to a binary file.
+//! Call between cycles. Resuming from a checkpoint taken between generations gives the same results as not stopping.
+//! Only the main world is saved. The replicas are cloned afresh when the loaded simulation starts its next cycle,
+//! so with replicas, only checkpoints taken between generations resume exactly.
+//! @param[in] path Where to write. Overwritten if it exists.
+//! @return false if the file couldn't be written.
+bool Simulation::SaveCheckpoint(std::string const& path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));  // Including the padding, so the file is the same every time.
+    std::memcpy(header.magic, c_checkpointMagic, sizeof(header.magic));
+    header.version = c_checkpointVersion;
+    header.byteOrderMark = c_checkpointByteOrderMark;
+    header.seed = m_seed;
+    header.generation = m_generation;
+    header.numFoxes = static_cast<uint32_t>(m_world.foxes.size());
+    header.cloverRng = m_world.cloverRng.GetState();
+    util::WriteRaw(out, header);
+
+    // Clovers.
+    std::vector<float> x, y;
+    std::vector<unsigned> hp;
+    for (size_t i = 0; i < m_world.clovers.Size(); ++i)
+    {
+        x.push_back(m_world.clovers[i].X());
+        y.push_back(m_world.clovers[i].Y());
+        hp.push_back(m_world.clovers[i].Hp());
+    }
+    util::WritePadding(out);
+    util::WriteRaw(out, uint64_t(m_world.clovers.Size()));
+    for (auto const* array : { &x, &y })
+    {
+        util::WritePadding(out);
+        util::WriteRaw(out, array->data(), array->size());
+    }
+    util::WritePadding(out);
+    util::WriteRaw(out, hp.data(), hp.size());
+
+    // Bunnies.
+    util::WritePadding(out);
+    m_world.bunnies->Save(out);
+
+    // Foxes.
+    std::vector<float> foxX, foxY, foxAngle, genomes;
+    std::vector<unsigned> foxScore;
+    for (Fox const& fox : m_world.foxes)
+    {
+        foxX.push_back(fox.X());
+        foxY.push_back(fox.Y());
+        foxAngle.push_back(fox.Angle());
+        foxScore.push_back(fox.NumBunniesEaten());
+        Eigen::VectorXf const genome = fox.Genome();
+        genomes.insert(genomes.end(), genome.data(), genome.data() + genome.size());
+    }
+    for (auto const* array : { &foxX, &foxY, &foxAngle })
+    {
+        util::WritePadding(out);
+        util::WriteRaw(out, array->data(), array->size());
+    }
+    util::WritePadding(out);
+    util::WriteRaw(out, foxScore.data(), foxScore.size());
+    util::WritePadding(out);
+    util::WriteRaw(out, genomes.data(), genomes.size());
+
+    return static_cast<bool>(out);
+}
+
+//! Replace the whole state of the simulation with a checkpoint written by SaveCheckpoint.
+//! The number of bunnies, clovers, and foxes, and the brains' activation functions, come from the file.
+//! The settings the simulation was constructed with (threads, selection policy) are kept.
+//! @param[in] path The file to read.
+//! @return false if the file is missing, truncated, or not a checkpoint of this version. The simulation is unchanged on failure.
+bool Simulation::LoadCheckpoint(std::string const& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    CheckpointHeader header{};
+    if (!in || !util::ReadRaw(in, header))
+        return false;
+    if (std::memcmp(header.magic, c_checkpointMagic, sizeof(header.magic)) != 0
+        || header.version != c_checkpointVersion || header.byteOrderMark != c_checkpointByteOrderMark)
+        return false;
+
+    // Clovers.
+    uint64_t numClovers = 0;
+    if (!util::SkipPadding(in) || !util::ReadRaw(in, numClovers) || numClovers == 0 || !util::CanRead<float>(in, numClovers))
+        return false;
+    auto const count = static_cast<size_t>(numClovers);
+    std::vector<float> x(count), y(count);
+    std::vector<unsigned> hp(count);
+    if (!util::SkipPadding(in) || !util::ReadRaw(in, x.data(), count)
+        || !util::SkipPadding(in) || !util::ReadRaw(in, y.data(), count)
+        || !util::SkipPadding(in) || !util::ReadRaw(in, hp.data(), count))
+        return false;
+
+    // Bunnies.
+    auto bunnies = std::make_shared<BunnyPopulation>(0);
+    if (!util::SkipPadding(in) || !bunnies->Load(in) || bunnies->Size() == 0)
+        return false;
+
+    // Foxes. Each one has a position, an angle, a score, and a genome.
+    if (!util::CanRead<float>(in, header.numFoxes * uint64_t(4 + Fox::Brain::GENOME_SIZE)))
+        return false;
+    auto const numFoxes = static_cast<size_t>(header.numFoxes);
+    std::vector<float> foxX(numFoxes), foxY(numFoxes), foxAngle(numFoxes);
+    std::vector<unsigned> foxScore(numFoxes);
+    Eigen::VectorXf genome(Fox::Brain::GENOME_SIZE);
+    std::vector<Fox> foxes(numFoxes);
+    if (!util::SkipPadding(in) || !util::ReadRaw(in, foxX.data(), numFoxes)
+        || !util::SkipPadding(in) || !util::ReadRaw(in, foxY.data(), numFoxes)
+        || !util::SkipPadding(in) || !util::ReadRaw(in, foxAngle.data(), numFoxes)
+        || !util::SkipPadding(in) || !util::ReadRaw(in, foxScore.data(), numFoxes)
+        || !util::SkipPadding(in))
+        return false;
+    for (size_t i = 0; i < numFoxes; ++i)
+    {
+        if (!util::ReadRaw(in, genome.data(), static_cast<size_t>(genome.size())))
+            return false;
+        foxes[i].SetGenome(genome);
+        foxes[i].X() = foxX[i];
+        foxes[i].Y() = foxY[i];
+        foxes[i].Angle() = foxAngle[i];
+        foxes[i].NumBunniesEaten() = foxScore[i];
+    }
+
+    // Everything was read. Swap it in.
+    m_seed = header.seed;
+    m_generation = header.generation;
+    m_activations = bunnies->GetActivations();
+    m_cycle = 0;
+    m_world.cloverRng = util::Philox4x32(header.cloverRng);
+
+    m_world.clovers = CloverPool(count);
+    m_world.cloverGrid = SpatialGrid(SpatialGrid::CellsPerSideFor(count));
+    m_world.cloverGrid.Reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_world.clovers.Spawn(x[i], y[i]);
+        m_world.clovers[i].Hp() = hp[i];
+        m_world.cloverGrid.Insert(i, x[i], y[i]);
+    }
+
+    if (bunnies->Size() != m_parents.Size())
+        m_parents = ml::AliasTable(ml::RankWeights(m_selection, bunnies->Size()));
+    if (numFoxes > 0 && numFoxes != m_foxParents.Size())
+        m_foxParents = ml::AliasTable(ml::RankWeights(m_selection, numFoxes));
+    m_world.bunnies = std::move(bunnies);
+    m_world.nearestClover.assign(m_world.bunnies->Size(), 0);
+    m_world.targetX.assign(m_world.bunnies->Size(), 0);
+    m_world.targetY.assign(m_world.bunnies->Size(), 0);
+
+    m_world.foxes = std::move(foxes);
+    m_world.nearestBunny.assign(numFoxes, 0);
+    m_nextFoxes = m_world.foxes;
+
+    return true;
+}
+
+//! Copy a bunny out, e.g. to send it to another simulation.
+//! @param[in] index Index of the bunny in the current generation.
+//! @return The bunny's genes and score. The score is the total over every world.
+Simulation::Individual Simulation::Emigrate(size_t const index) const
+{
+    return { m_world.bunnies->Genome(index), m_world.bunnies->NumCloversEaten(index) };
+}
+
+//! Overwrite a bunny with one from elsewhere. It keeps its score, so it ranks as it did where it came from.
+//! @param[in] index      Index of the bunny in the current generation to replace.
+//! @param[in] individual The bunny to put in its place.
+void Simulation::Immigrate(size_t const index, Individual const& individual)
+{
+    m_world.bunnies->SetGenome(index, individual.genome);
+    m_world.bunnies->NumCloversEaten(index) = individual.numCloversEaten;
+}
+
+//! Copy out where everything in the main world is, e.g. for another thread to draw.
+//! @param[out] out_snapshot Overwritten. Reuses its memory, so filling in the same snapshot again doesn't allocate.
+void Simulation::TakeSnapshot(WorldSnapshot& out_snapshot) const
+{
+    out_snapshot.clovers.resize(m_world.clovers.Size());
+    for (size_t i = 0; i < m_world.clovers.Size(); ++i)
+    {
+        Clover const& clover = m_world.clovers[i];
+        out_snapshot.clovers[i] = { clover.X(), clover.Y(), clover.Angle(), clover.Radius() };
+    }
+
+    BunnyPopulation const& bunnies = *m_world.bunnies;
+    out_snapshot.bunnies.resize(bunnies.Size());
+    for (size_t i = 0; i < bunnies.Size(); ++i)
+        out_snapshot.bunnies[i] = { bunnies.X(i), bunnies.Y(i), bunnies.Angle(i), bunnies.Radius(i) };
+
+    out_snapshot.foxes.resize(m_world.foxes.size());
+    for (size_t i = 0; i < m_world.foxes.size(); ++i)
+    {
+        Fox const& fox = m_world.foxes[i];
+        out_snapshot.foxes[i] = { fox.X(), fox.Y(), fox.Angle(), fox.Radius() };
+    }
+
+    out_snapshot.generation = m_generation;
+}
+
+//! @return The number of the current generation, starting at 0.
+unsigned Simulation::Generation() const
+{
+    return m_generation;
+}
+
+//! @return The seed the run was started with.
+uint64_t Simulation::Seed() const
+{
+    return m_seed;
+}
+
+//! @return The number of foxes in each world.
+size_t Simulation::NumFoxes() const
+{
+    return m_world.foxes.size();
+}
+
+//! @return The number of cycles that make up one generation.
+unsigned Simulation::CyclesPerGeneration()
+{
+    return Globals::c_secondsPerGeneration * Globals::c_cyclesPerSecond;
+}
+
+//! Rank the bunnies as Rank does, into a collection that is reused from call to call.
+//! @param[out] out_ranked Overwritten with the indexes of the bunnies, best first.
+void Simulation::rank(std::vector<size_t>& out_ranked) const
+{
+    BunnyPopulation const& bunnies = *m_world.bunnies;
+
+    util::ScopedTimer const timer("sort");
+    rankBy(bunnies.Size(), [&bunnies](size_t const index) { return bunnies.NumCloversEaten(index); }, out_ranked);
+}
+
+//! Rank the foxes by the number of bunnies caught, summed over every world.
+//! @param[out] out_ranked Overwritten with the indexes of the foxes, best first.
+void Simulation::rankFoxes(std::vector<size_t>& out_ranked) const
+{
+    std::vector<Fox> const& foxes = m_world.foxes;
+    rankBy(foxes.size(), [&foxes](size_t const index) { return foxes[index].NumBunniesEaten(); }, out_ranked);
+}
+
+//! Split the animals of every world into ranges on the thread pool. Every world has the same number, so they are split up as one range.
+//! @param[in] countPerWorld The number of animals in each world.
+//! @param[in] grainSize     Fewer animals than this aren't worth waking another thread for.
+//! @param[in] function      Called for each range. Signature must be (World& world, size_t begin, size_t end) -> void.
+template <typename Function>
+void Simulation::forEachWorld(size_t const countPerWorld, size_t const grainSize, Function&& function)
+{
+    if (countPerWorld == 0)
+        return;
+    m_threadPool.ParallelFor((1 + m_replicas.size()) * countPerWorld, grainSize, [this, countPerWorld, &function](size_t begin, size_t const end) {
+        // A chunk can span worlds. Split it where one world ends and the next begins.
+        while (begin < end)
+        {
+            size_t const index = begin / countPerWorld;
+            size_t const worldEnd = std::min(end, (index + 1) * countPerWorld);
+            function(world(index), begin - index * countPerWorld, worldEnd - index * countPerWorld);
+            begin = worldEnd;
+        }
+    });
+}
+
+//! @param[in] index 0 for the main world, or 1 + the index of a replica.
+Simulation::World& Simulation::world(size_t const index)
+{
+    return index == 0 ? m_world : m_replicas[index - 1];
+}
+
+//! Sense, think, act, and check bounds for a range of one world's bunnies. Only touches those bunnies and their scratch space.
+void Simulation::step(World& world, size_t const begin, size_t const end)
+{
+    BunnyPopulation& bunnies = *world.bunnies;
+
+    // Find nearest clovers.
+    {
+        util::ScopedTimer const timer("sense");
+        world.cloverGrid.Nearest(&bunnies.X(begin), &bunnies.Y(begin), end - begin, &world.nearestClover[begin]);
+        for (size_t i = begin; i < end; ++i)
+        {
+            world.targetX[i] = world.clovers[world.nearestClover[i]].X();
+            world.targetY[i] = world.clovers[world.nearestClover[i]].Y();
+        }
+    }
+    {
+        util::ScopedTimer const timer("think");
+        bunnies.Think(world.targetX, world.targetY, begin, end);
+    }
+    {
+        util::ScopedTimer const timer("act");
+        bunnies.Act(begin, end);
+    }
+    // Check bounds.
+    {
+        util::ScopedTimer const timer("bounds");
+        bunnies.EnforceBounds(begin, end);
+    }
+}
+
+//! Sense, think, act, and check bounds for a range of one world's foxes. Each fox chases the nearest bunny, as of the start of the cycle.
+void Simulation::stepFoxes(World& world, size_t const begin, size_t const end)
+{
+    util::ScopedTimer const timer("foxes");
+    for (size_t i = begin; i < end; ++i)
+    {
+        Fox& fox = world.foxes[i];
+        size_t const nearest = world.bunnyGrid.Nearest(fox.X(), fox.Y());
+        world.nearestBunny[i] = nearest;
+        fox.Think(world.bunnyGrid.X(nearest), world.bunnyGrid.Y(nearest));
+        fox.Act();
+        EnforceBounds(fox.X(), fox.Y());
+    }
+}
+
+//! Handle bunny/clover collision in one world. In bunny order, so the first bunny to reach a clover gets the bite,
+//! and the eaten clovers respawn, drawing from the RNG in the same order every run.
+void Simulation::eat(World& world)
+{
+    BunnyPopulation& bunnies = *world.bunnies;
+
+    util::ScopedTimer const timer("collision");
+    for (size_t i = 0; i < bunnies.Size(); ++i)
+    {
+        size_t const nearestCloverIndex = world.nearestClover[i];
+        Clover& nearestClover = world.clovers[nearestCloverIndex];
+        if (DistanceSquared(bunnies.X(i), bunnies.Y(i), nearestClover.X(), nearestClover.Y()) < bunnies.Radius(i) * bunnies.Radius(i))
+        {
+            if (nearestClover.Bite())
+            {
+                bunnies.NumCloversEaten(i) += 1;
+                util::Profiler::Get().Count("bites");
+            }
+            // If the clover is out of HP, reset it.
+            if (nearestClover.Hp() == 0)
+            {
+                util::Profiler::Get().Count("respawns");
+                respawnClover(world, nearestCloverIndex);
+            }
+        }
+    }
+}
+
+//! Handle fox/bunny collision in one world. In fox order, like eating.
+//! A fox catches the bunny it was chasing if it is within the fox's radius. The bunny escapes to a random spot, losing the ground it had covered.
+//! Bunnies can't see foxes yet, so that is the only cost to them. Their brains only take the nearest clover, so there is no index of the
+//! foxes and no nearest-fox query. Seeing foxes would take a MovingGrid of the foxes and more inputs to the bunnies' brains.
+void Simulation::hunt(World& world)
+{
+    BunnyPopulation& bunnies = *world.bunnies;
+
+    util::ScopedTimer const timer("hunt");
+    for (size_t i = 0; i < world.foxes.size(); ++i)
+    {
+        Fox& fox = world.foxes[i];
+        size_t const nearestBunny = world.nearestBunny[i];
+        if (DistanceSquared(fox.X(), fox.Y(), bunnies.X(nearestBunny), bunnies.Y(nearestBunny)) < fox.Radius() * fox.Radius())
+        {
+            fox.NumBunniesEaten() += 1;
+            util::Profiler::Get().Count("catches");
+            bunnies.X(nearestBunny) = s_distPosition(world.cloverRng);
+            bunnies.Y(nearestBunny) = s_distPosition(world.cloverRng);
+        }
+    }
+}
+
+//! Replace the foxes with children bred from the best of them, the same way as the bunnies.
+void Simulation::breedFoxes()
+{
+    rankFoxes(m_foxRanked);
+    m_foxChildren.resize(m_world.foxes.size());
+    std::iota(m_foxChildren.begin(), m_foxChildren.end(), size_t(0));
+
+    auto lRngForChild = [this](size_t const c) {
+        return util::Philox4x32(m_seed, c_streamFoxBreeding, m_generation, static_cast<uint32_t>(c)); };
+    auto lBreedChildFox = [this](size_t const m, size_t const f, size_t& out_c, util::Philox4x32& rng) {
+        Fox::Crossover(m_world.foxes[m], m_world.foxes[f], m_nextFoxes[out_c], rng); };
+    ml::BreedPopChance(m_foxRanked, m_foxChildren, lRngForChild, lBreedChildFox, m_foxParents);
+    m_world.foxes.swap(m_nextFoxes);
+    placeFoxes(m_world.foxes, m_generation + 1);
+}
+
+//! Start each replica on the generation: a copy of the main world's bunnies as they start out, among a fresh layout of clovers.
+//! The layouts come from their own streams, keyed by generation and replica, so checkpoints don't need to store them.
+void Simulation::cloneReplicas()
+{
+    size_t const numClovers = m_world.clovers.Size();
+    BunnyPopulation const& bunnies = *m_world.bunnies;
+    for (size_t r = 0; r < m_replicas.size(); ++r)
+    {
+        World& replica = m_replicas[r];
+        replica.cloverRng = util::Philox4x32(m_seed, c_streamReplicas, m_generation, static_cast<uint32_t>(r));
+
+        // The clovers and the grid from the last generation are reset in place. Only the first generation creates them.
+        if (replica.clovers.Capacity() != numClovers)  // E.g. a loaded checkpoint had a different number.
+        {
+            replica.clovers = CloverPool(numClovers);
+            replica.cloverGrid = SpatialGrid(SpatialGrid::CellsPerSideFor(numClovers));
+            replica.cloverGrid.Reserve(numClovers);
+        }
+        size_t const numSpawned = replica.clovers.Size();
+        replica.cloverGrid.Clear();
+        for (size_t i = 0; i < numClovers; ++i)
+        {
+            float const x = s_distPosition(replica.cloverRng);
+            float const y = s_distPosition(replica.cloverRng);
+            if (i < numSpawned)
+                replica.clovers.Respawn(i, x, y);
+            else
+                replica.clovers.Spawn(x, y);
+            replica.cloverGrid.Insert(i, x, y);
+        }
+
+        // Copy assignment reuses the memory from the last generation.
+        if (replica.bunnies)
+            *replica.bunnies = bunnies;
+        else
+            replica.bunnies = std::make_shared<BunnyPopulation>(bunnies);
+        for (size_t i = 0; i < bunnies.Size(); ++i)
+            replica.bunnies->NumCloversEaten(i) = 0;
+        replica.nearestClover.resize(bunnies.Size());
+        replica.targetX.resize(bunnies.Size());
+        replica.targetY.resize(bunnies.Size());
+
+        replica.foxes = m_world.foxes;
+        replica.nearestBunny.resize(m_world.foxes.size());
+    }
+}
+
+//! Move the bites taken in the replicas into the main world's scores, so those always hold each bunny's total over every world.
+void Simulation::foldReplicaScores()
+{
+    BunnyPopulation& bunnies = *m_world.bunnies;
+    for (World& replica : m_replicas)
+    {
+        for (size_t i = 0; i < bunnies.Size(); ++i)
+        {
+            bunnies.NumCloversEaten(i) += replica.bunnies->NumCloversEaten(i);
+            replica.bunnies->NumCloversEaten(i) = 0;
+        }
+        for (size_t i = 0; i < m_world.foxes.size(); ++i)
+        {
+            m_world.foxes[i].NumBunniesEaten() += replica.foxes[i].NumBunniesEaten();
+            replica.foxes[i].NumBunniesEaten() = 0;
+        }
+    }
+}
+
+//! Add a clover to a world's pool at a random spot.
+void Simulation::spawnClover(World& world)
+{
+    float const x = s_distPosition(world.cloverRng);
+    float const y = s_distPosition(world.cloverRng);
+    size_t const index = world.clovers.Spawn(x, y);
+    world.cloverGrid.Insert(index, x, y);
+}
+
+//! Bring an eaten clover back at a random spot, in place. Doesn't allocate.
+void Simulation::respawnClover(World& world, size_t const index)
+{
+    float const x = s_distPosition(world.cloverRng);
+    float const y = s_distPosition(world.cloverRng);
+    world.clovers.Respawn(index, x, y);
+    world.cloverGrid.Move(index, x, y);
+}
+
+std::shared_ptr<BunnyPopulation> Simulation::makeBunnies(size_t const size, unsigned const generation)
+{
+    auto bunnies = std::make_shared<BunnyPopulation>(size);
+    bunnies->SetActivations(m_activations);
+    placeBunnies(*bunnies, generation);
+    return bunnies;
+}
+
+//! Put each bunny at its starting position and angle for a generation. Each bunny gets its own stream.
+void Simulation::placeBunnies(BunnyPopulation& bunnies, unsigned const generation) const
+{
+    for (size_t i = 0; i < bunnies.Size(); ++i)
+    {
+        util::Philox4x32 rng(m_seed, c_streamBunnySpawn, generation, static_cast<uint32_t>(i));
+        bunnies.X(i) = s_distPosition(rng);
+        bunnies.Y(i) = s_distPosition(rng);
+        bunnies.Angle(i) = s_distAngle(rng);
+    }
+}
+
+//! Put each fox at its starting position and angle for a generation, with no catches. Each fox gets its own stream.
+void Simulation::placeFoxes(std::vector<Fox>& foxes, unsigned const generation) const
+{
+    for (size_t i = 0; i < foxes.size(); ++i)
+    {
+        util::Philox4x32 rng(m_seed, c_streamFoxSpawn, generation, static_cast<uint32_t>(i));
+        foxes[i].X() = s_distPosition(rng);
+        foxes[i].Y() = s_distPosition(rng);
+        foxes[i].Angle() = s_distAngle(rng);
+        foxes[i].NumBunniesEaten() = 0;
+    }
+}
+
+} }
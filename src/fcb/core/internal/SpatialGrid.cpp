@@ -0,0 +1,203 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "core/SpatialGrid.h"
+
+#include "GridSearch.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "core/NearestNeighbor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace fcb { namespace core {
+
+namespace {
+
+    // Up to this many items, checking every one (see NearestBruteForce) is faster than searching the grid.
+    size_t constexpr c_maxBruteForceItems = 512;
+
+}  // Anonymous namespace.
+
+
+//! Constructor.
+//! @param[in] cellsPerSide The number of cells along each axis. The world bounds are divided evenly.
+SpatialGrid::SpatialGrid(size_t const cellsPerSide)
+    : m_cellsPerSide(std::max<size_t>(cellsPerSide, 1))
+    , m_cellWidth((Globals::c_worldRightBound - Globals::c_worldLeftBound) / static_cast<float>(m_cellsPerSide))
+    , m_cellHeight((Globals::c_worldTopBound - Globals::c_worldBottomBound) / static_cast<float>(m_cellsPerSide))
+    , m_cells(m_cellsPerSide * m_cellsPerSide)
+{ }
+
+//! A reasonable grid resolution for a number of items. Aims for a couple of items per cell.
+//! @param[in] numItems The number of items expected to be in the grid.
+//! @return The number of cells to use along each axis.
+size_t SpatialGrid::CellsPerSideFor(size_t const numItems)
+{
+    return std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(numItems) / 2)));
+}
+
+//! Make room for a number of items up front, so moving them around rarely allocates.
+//! Each cell gets room for several times its share: bunnies graze some cells bare, and the clovers respawned elsewhere pile up in the rest.
+//! @param[in] numItems The number of items expected to be in the grid.
+void SpatialGrid::Reserve(size_t const numItems)
+{
+    m_x.reserve(numItems);
+    m_y.reserve(numItems);
+    m_cellOf.reserve(numItems);
+    m_slotOf.reserve(numItems);
+
+    size_t const perCell = 8 * (numItems / m_cells.size() + 1);
+    for (auto& items : m_cells)
+        items.reserve(perCell);
+}
+
+//! Add an item to the grid.
+//! @param[in] index The item's index. Items must be inserted in order, i.e. index must equal Size().
+//! @param[in] x     The item's x-coordinate.
+//! @param[in] y     The item's y-coordinate.
+void SpatialGrid::Insert(size_t const index, float const x, float const y)
+{
+    assert(index == Size());
+
+    size_t const cell = cellRow(y) * m_cellsPerSide + cellColumn(x);
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_cellOf.push_back(cell);
+    m_slotOf.push_back(m_cells[cell].size());
+    m_cells[cell].push_back(index);
+}
+
+//! Update an item's position. Moves the item to a different cell if needed.
+//! @param[in] index The item's index.
+//! @param[in] x     The item's new x-coordinate.
+//! @param[in] y     The item's new y-coordinate.
+void SpatialGrid::Move(size_t const index, float const x, float const y)
+{
+    assert(index < Size());
+
+    m_x[index] = x;
+    m_y[index] = y;
+
+    size_t const oldCell = m_cellOf[index];
+    size_t const newCell = cellRow(y) * m_cellsPerSide + cellColumn(x);
+    if (oldCell == newCell)
+        return;
+
+    // Swap-and-pop out of the old cell.
+    auto& oldItems = m_cells[oldCell];
+    size_t const slot = m_slotOf[index];
+    oldItems[slot] = oldItems.back();
+    m_slotOf[oldItems[slot]] = slot;
+    oldItems.pop_back();
+
+    // Append to the new cell.
+    m_cellOf[index] = newCell;
+    m_slotOf[index] = m_cells[newCell].size();
+    m_cells[newCell].push_back(index);
+}
+
+//! Remove every item. Keeps the memory, so filling the grid up again to the same size doesn't allocate.
+void SpatialGrid::Clear()
+{
+    for (auto& items : m_cells)
+        items.clear();
+    m_x.clear();
+    m_y.clear();
+    m_cellOf.clear();
+    m_slotOf.clear();
+}
+
+//! Find the item nearest to a point.
+//! Searches rings of cells outward from the point's cell and stops once no unsearched cell can hold anything closer.
+//! The grid must not be empty.
+//! @param[in] x The x-coordinate of the point.
+//! @param[in] y The y-coordinate of the point.
+//! @return The index of the nearest item.
+size_t SpatialGrid::Nearest(float const x, float const y) const
+{
+    assert(Size() > 0);
+
+    return NearestInGrid(m_cellsPerSide, m_cellWidth, m_cellHeight, cellColumn(x), cellRow(y),
+        [&](size_t const column, size_t const row, size_t& inout_best, float& inout_bestDistanceSquared) {
+            searchCell(column, row, x, y, inout_best, inout_bestDistanceSquared);
+        },
+        [&] { return nearestLinear(x, y); });
+}
+
+//! Find the item nearest to each of several points. The same results as asking for each point on its own.
+//! With few items, checking all of them for a whole batch of points at once is faster than searching the grid.
+//! The grid must not be empty.
+//! @param[in]  x           The x-coordinate of each point.
+//! @param[in]  y           The y-coordinate of each point.
+//! @param[in]  count       The number of points.
+//! @param[out] out_nearest The index of the nearest item to each point. Must have room for count.
+void SpatialGrid::Nearest(float const* x, float const* y, size_t const count, size_t* out_nearest) const
+{
+    assert(Size() > 0);
+
+    if (Size() <= c_maxBruteForceItems)
+    {
+        NearestBruteForce(x, y, count, m_x.data(), m_y.data(), Size(), out_nearest);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+        out_nearest[i] = Nearest(x[i], y[i]);
+}
+
+//! @return The number of items in the grid.
+size_t SpatialGrid::Size() const
+{
+    return m_x.size();
+}
+
+size_t SpatialGrid::cellColumn(float const x) const
+{
+    return ToGridCell(x, Globals::c_worldLeftBound, m_cellWidth, m_cellsPerSide);
+}
+
+size_t SpatialGrid::cellRow(float const y) const
+{
+    return ToGridCell(y, Globals::c_worldBottomBound, m_cellHeight, m_cellsPerSide);
+}
+
+//! Check the items in one cell against the best candidate so far.
+void SpatialGrid::searchCell(size_t const column, size_t const row, float const x, float const y, size_t& inout_best, float& inout_bestDistanceSquared) const
+{
+    for (size_t const index : m_cells[row * m_cellsPerSide + column])
+    {
+        float const distanceSquared = DistanceSquared(x, y, m_x[index], m_y[index]);
+        if (distanceSquared < inout_bestDistanceSquared || (distanceSquared == inout_bestDistanceSquared && index < inout_best))
+        {
+            inout_bestDistanceSquared = distanceSquared;
+            inout_best = index;
+        }
+    }
+}
+
+//! Brute-force search over every item.
+size_t SpatialGrid::nearestLinear(float const x, float const y) const
+{
+    return NearestBruteForce(x, y, m_x.data(), m_y.data(), Size());
+}
+
+
+} }
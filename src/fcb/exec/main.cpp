@@ -16,26 +16,20 @@
 
 // Language: ISO C++17
 
-#define _USE_MATH_DEFINES
-#include <cmath>
-
-#include "core/Clover.h"
-#include "core/Bunny.h"
-#include "core/Fox.h"
 #include "core/Globals.h"
+#include "core/Simulation.h"
+#include "core/WorldSnapshot.h"
 #include "input/InputState.h"
-#include "graphics/ObjectRegistry.h"
+#include "graphics/Draw.h"
 #include "gui/Gui.h"
-#include "ml/GeneticAlgorithmPairing.h"
-#include "util/Util.h"
-
-#include <PerformanceTimer98.hpp>
+#include "util/FramePacer.h"
+#include "util/Profiler.h"
+#include "util/TripleBuffer.h"
 
-#include <thread>
-#include <memory>
-#include <random>
-#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <thread>
 
 using namespace fcb;
 using namespace fcb::core;
@@ -43,142 +37,97 @@ using namespace fcb::core;
 
 namespace {
 
-std::uniform_real_distribution<float> s_distPosition(-1, 1);
-std::uniform_real_distribution<float> s_distAngle(0, 2 * static_cast<float>(M_PI));
-
-std::shared_ptr<Clover> MakeClover()
-{
-    auto clover = std::make_shared<Clover>();
-    clover->X() = s_distPosition(util::rng());
-    clover->Y() = s_distPosition(util::rng());
-    graphics::RegisterObject(clover);
-    return clover;
-}
-
-std::shared_ptr<Bunny> MakeBunny()
-{
-    auto bunny = std::make_shared<Bunny>();
-    bunny->X() = s_distPosition(util::rng());
-    bunny->Y() = s_distPosition(util::rng());
-    bunny->Angle() = s_distAngle(util::rng());
-    graphics::RegisterObject(bunny);
-    return bunny;
-}
-
-std::shared_ptr<Fox> MakeFox()
-{
-    auto fox = std::make_shared<Fox>();
-    fox->X() = s_distPosition(util::rng());
-    fox->Y() = s_distPosition(util::rng());
-    fox->Angle() = s_distAngle(util::rng());
-    graphics::RegisterObject(fox);
-    return fox;
-}
+using SnapshotBuffer = util::TripleBuffer<WorldSnapshot>;
 
-void EnforceBounds(GameObject& object)
-{
-    if (object.X() > Globals::c_worldRightBound)
-        object.X() = Globals::c_worldWrap ? Globals::c_worldLeftBound : Globals::c_worldRightBound;
-    else if (object.X() < Globals::c_worldLeftBound)
-        object.X() = Globals::c_worldWrap ? Globals::c_worldRightBound : Globals::c_worldLeftBound;
-
-    if (object.Y() > Globals::c_worldTopBound)
-        object.Y() = Globals::c_worldWrap ? Globals::c_worldBottomBound : Globals::c_worldTopBound;
-    else if (object.Y() < Globals::c_worldBottomBound)
-        object.Y() = Globals::c_worldWrap ? Globals::c_worldTopBound : Globals::c_worldBottomBound;
-}
+double constexpr c_framesPerSecond = 60;
 
-void run()
+//! Run the simulation until told to stop, publishing snapshots to draw.
+//! Runs at the speed set in the input state. Faster speeds run several cycles per tick of real time,
+//! so the pacer still sleeps between the batches instead of spinning.
+//! @param[out] snapshots Where to publish the snapshots.
+//! @param[in]  stop      Set by another thread to stop.
+void simulate(SnapshotBuffer& snapshots, std::atomic<bool> const& stop)
 {
-    UNUSED(MakeFox());
-
-    std::vector<std::shared_ptr<Clover>> clovers;
-    std::vector<std::shared_ptr<Bunny>> bunnies;
-
-    for (int i = 0; i < 200; ++i)
-        clovers.push_back(MakeClover());
-
-    for (int i = 0; i < 50; ++i)
-        bunnies.push_back(MakeBunny());
-
-    PerformanceTimer98 timer;
-    unsigned generation = 0;
+    Simulation simulation;
+    util::FramePacer pacer(Globals::c_cyclesPerSecond);
+    input::InputState const& inputState = input::GetInputState();
+    unsigned cyclesThisTick = 0;
+    unsigned cyclesSinceDraw = 0;
 
-    while (!input::GetInputState().exit)
+    while (!stop)
     {
-        std::cout << "Generation: " << generation << std::endl;
+        std::cout << "Generation: " << simulation.Generation() << std::endl;
 
         // Run the current generation.
-        timer.Start();
-        for (unsigned numCycles = 0; !input::GetInputState().exit && numCycles < Globals::c_secondsPerGeneration * 60; ++numCycles)
+        pacer.ResetStatistics();
+        for (unsigned numCycles = 0; !stop && numCycles < Simulation::CyclesPerGeneration(); ++numCycles)
         {
-            for (auto& bunny : bunnies)
-            {
-                // Find nearest clover.
-                auto nearestCloverIter = std::min_element(clovers.begin(), clovers.end(), [&bunny](auto const& left, auto const& right) {
-                    return bunny->DistanceSquared(*left) < bunny->DistanceSquared(*right); });
-                auto nearestClover = *nearestCloverIter;
-
-                bunny->Think(*nearestClover);
-
-                bunny->Act();
-
-                // Check bounds.
-                EnforceBounds(*bunny);
-
-                // Handle bunny/clover collision.
-                if (bunny->Distance(*nearestClover) < bunny->Radius())
-                {
-                    if (nearestClover->Bite())
-                        bunny->NumCloversEaten() += 1;
-                    // If the clover is out of HP, reset it.
-                    if (nearestClover->Hp() == 0)
-                        *nearestCloverIter = MakeClover();
-                }
-            }
+            simulation.Cycle();
 
-            // Draw.
-            if (!input::GetInputState().fastForward)
+            if (++cyclesSinceDraw >= inputState.cyclesPerDraw)
             {
-                gui::Draw();
-
-                // Wait for the frame time to expire.
-                for (timer.Stop(); !timer.IntervalHasElapsed(); timer.Stop())
-                    std::this_thread::yield();
-                timer.Start();
+                cyclesSinceDraw = 0;
+                simulation.TakeSnapshot(snapshots.Back());
+                snapshots.Publish();
             }
-            else
+
+            // Wait for the next tick after running this tick's share of cycles.
+            unsigned const speed = inputState.speed;
+            if (speed != input::InputState::c_uncapped && ++cyclesThisTick >= speed)
             {
-                // When fast-forwarding, still check for events every so often.
-                timer.Stop();
-                if (timer.GetElapsed() > 100)
-                {
-                    gui::HandleEvents();
-                    timer.Start();
-                }
+                cyclesThisTick = 0;
+                pacer.Wait();
             }
         }
 
-        // Handle keyboard events (needed if fast-forwarding).
-        gui::HandleEvents();
+        // Rank the bunnies and create the next generation.
+        unsigned const topScore = simulation.NextGeneration();
+        std::cout << "    Bunny top score: " << topScore << std::endl;
 
-        // Rank the bunnies.
-        std::sort(bunnies.begin(), bunnies.end(), [](auto& left, auto& right) { return left->NumCloversEaten() > right->NumCloversEaten(); });
-        std::cout << "    Bunny top score: " << bunnies[0]->NumCloversEaten() << std::endl;
+        util::FramePacer::Statistics const pacing = pacer.GetStatistics();
+        util::WriteReport(std::cout, util::Profiler::Get().TakeReport());
+        std::cout << "    Tick time: " << pacing.meanFrameTime << " ms (std dev " << pacing.frameTimeStdDev << " ms)"
+                  << ", late by " << pacing.meanLateness << " ms (max " << pacing.maxLateness << " ms)" << std::endl;
+    }
+}
 
-        // Create the next generation.
-        std::vector<std::shared_ptr<Bunny>> bunniesSwap;
-        for (size_t i = 0; i < bunnies.size(); ++i)
-            bunniesSwap.push_back(MakeBunny());
+//! Draw the newest snapshot every frame, and handle input, until the window closes.
+//! @param[in] snapshots Where the simulation publishes its snapshots.
+void render(SnapshotBuffer& snapshots)
+{
+    util::FramePacer pacer(c_framesPerSecond);
 
-        // Do GA breeding.
-        auto lCrossoverHelperBunny = [](std::shared_ptr<Bunny> const& m, std::shared_ptr<Bunny> const& f, std::shared_ptr<Bunny>& out_c) {
-            Bunny::Crossover(*m, *f, *out_c); };
-        ml::BreedPopChance50(bunnies, bunniesSwap, lCrossoverHelperBunny);
-        std::swap(bunnies, bunniesSwap);
+    while (!input::GetInputState().exit)
+    {
+        if (snapshots.Acquire())
+            graphics::SetSnapshot(&snapshots.Front());
+        {
+            util::ScopedTimer const timer("draw");
+            gui::Draw();
+        }
 
-        ++generation;
+        // Sleep until the next frame.
+        pacer.Wait();
     }
+
+    graphics::SetSnapshot(nullptr);
+}
+
+//! The GUI has to stay on the main thread, so the simulation gets a thread of its own.
+//! The two only share snapshots and the input state, so neither slows the other down.
+void run()
+{
+    // Report where each generation's time goes. Totals only, with no trace.
+    util::Profiler::Get().Enable();
+
+    SnapshotBuffer snapshots;
+    std::atomic<bool> stop(false);
+    std::thread simulationThread(simulate, std::ref(snapshots), std::cref(stop));
+
+    render(snapshots);
+
+    stop = true;
+    simulationThread.join();
 }
 
 }  // Anonymous namespace.
@@ -18,6 +18,10 @@
 
 #pragma once
 
+namespace fcb { namespace core {
+    struct WorldSnapshot;
+} }
+
 namespace fcb { namespace graphics {
 
 //! Draw the world and everything in it.
@@ -28,4 +32,9 @@ void Draw();
 //! Set all the OpenGL setup settings again.
 void Refresh();
 
+//! Draw this snapshot until another is set.
+//! Lets the world be drawn on a different thread than the one running it.
+//! @param[in] snapshot Must stay valid until replaced. nullptr draws an empty world.
+void SetSnapshot(fcb::core::WorldSnapshot const* snapshot);
+
 } }
@@ -33,5 +33,10 @@ void Refresh()
     World::Get().Refresh();
 }
 
+void SetSnapshot(fcb::core::WorldSnapshot const* snapshot)
+{
+    World::Get().SetSnapshot(snapshot);
+}
+
 
 } }
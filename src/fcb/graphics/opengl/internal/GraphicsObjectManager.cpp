@@ -18,61 +18,54 @@
 
 #include "GraphicsObjectManager.h"
 
+#include "ModelBunny.h"
+#include "ModelClover.h"
+#include "ModelFox.h"
+
 using namespace fcb::core;
 
 namespace fcb { namespace graphics {
 
 namespace {
 
-// Used with std::visit.
-template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
-template<class... Ts> overloaded(Ts...)->overloaded<Ts...>;  // Not needed after C++20.
-
-//! Draw the models in the given collection. The collection should be a std::vector.
-//! Removes the models from the collection if their associated game objects have been destroyed.
-//! @param[in/out] collection A std::vector of ModelClover, ModelBunny, or ModelFox.
-template <typename Model>
-void drawGroup(std::vector<Model>& collection)
+//! Add the objects in a snapshot to a batch.
+//! @param[in]  poses     One species from a WorldSnapshot.
+//! @param[out] out_batch The batch for the species.
+void drawPoses(std::vector<WorldSnapshot::Pose> const& poses, SpeciesBatch& out_batch)
 {
-    // A vector to hold const_iterators of another vector.
-    std::vector<typename std::vector<Model>::const_iterator> invalidIndexes;
-
-    for (auto iter = collection.cbegin(); iter != collection.cend(); ++iter)
-    {
-        bool const result = iter->DrawIfValid();
-        if (!result)
-            invalidIndexes.push_back(iter);
-    }
-
-    // Remove invalidated weak pointers. Erase in reverse so the iterators aren't invalidated.
-    for (auto iterIter = invalidIndexes.crbegin(); iterIter != invalidIndexes.crend(); ++iterIter)
-        collection.erase(*iterIter);
+    for (WorldSnapshot::Pose const& pose : poses)
+        out_batch.Add(pose.x, pose.y, pose.angle, pose.radius);
 }
 
 }  // Anonymous namespace.
 
 
-//! Saves a weak reference to a game object.
-//! @param[in] gameObject A weak pointer to a Fox, Clover, or Bunny.
-//! @return True if successful.
-bool GraphicsObjectManager::RegisterObject(GameObjectPointer gameObject)
-{
-    std::visit(overloaded{
-        [this](std::weak_ptr<Clover> clover) { m_clovers.emplace_back(std::move(clover)); },
-        [this](std::weak_ptr<Bunny>  bunny)  { m_bunnies.emplace_back(std::move(bunny)); },
-        [this](std::weak_ptr<Fox>    fox)    {   m_foxes.emplace_back(std::move(fox)); },
-    }, gameObject);
-
-    return true;
-}
+//! Constructor.
+GraphicsObjectManager::GraphicsObjectManager()
+    : m_cloverBatch(ModelClover::MakeBatch())
+    , m_bunnyBatch(ModelBunny::MakeBatch())
+    , m_foxBatch(ModelFox::MakeBatch())
+{ }
 
 //! Should only be called when OpenGL is ready to draw.
-//! Draws the objects. If an object is invalid, it is removed from the collection.
-void GraphicsObjectManager::draw()
+//! Draws the objects. Each species is gathered into its batch, then drawn with one call.
+//! @param[in] snapshot Optional. The objects to draw. nullptr draws nothing.
+void GraphicsObjectManager::draw(WorldSnapshot const* snapshot)
 {
-    drawGroup(m_clovers);
-    drawGroup(m_bunnies);
-    drawGroup(m_foxes);
+    m_cloverBatch.Clear();
+    m_bunnyBatch.Clear();
+    m_foxBatch.Clear();
+
+    if (snapshot)
+    {
+        drawPoses(snapshot->clovers, m_cloverBatch);
+        drawPoses(snapshot->bunnies, m_bunnyBatch);
+        drawPoses(snapshot->foxes, m_foxBatch);
+    }
+
+    m_cloverBatch.Draw();
+    m_bunnyBatch.Draw();
+    m_foxBatch.Draw();
 }
 
 
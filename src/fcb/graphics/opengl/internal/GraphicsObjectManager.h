@@ -18,34 +18,33 @@
 
 #pragma once
 
-#include "graphics/ObjectRegistry.h"
-#include "ModelBunny.h"
-#include "ModelClover.h"
-#include "ModelFox.h"
+#include "SpeciesBatch.h"
 
-#include <vector>
+#include "core/WorldSnapshot.h"
 
 namespace fcb { namespace graphics {
 
 //! Manages the extra information needed to represent objects graphically.
+//! Each species is gathered into one batch, so a whole snapshot takes one draw call per species.
 class GraphicsObjectManager
 {
 public:
-    bool RegisterObject(GameObjectPointer gameObject);
+    GraphicsObjectManager();
 
     friend class Attorney;
     class Attorney
     {
         friend class World;
-        static void Draw(GraphicsObjectManager& instance) { instance.draw(); }
+        static void Draw(GraphicsObjectManager& instance, fcb::core::WorldSnapshot const* snapshot) { instance.draw(snapshot); }
     };
 private:
     //! Should only be called when OpenGL is ready to draw.
-    void draw();
+    void draw(fcb::core::WorldSnapshot const* snapshot);
 
-    std::vector<ModelClover> m_clovers;
-    std::vector<ModelBunny>  m_bunnies;
-    std::vector<ModelFox>    m_foxes;
+    // One draw call per species.
+    SpeciesBatch m_cloverBatch;
+    SpeciesBatch m_bunnyBatch;
+    SpeciesBatch m_foxBatch;
 };
 
 } }
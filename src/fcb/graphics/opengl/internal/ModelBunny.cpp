@@ -18,51 +18,22 @@
 
 #include "ModelBunny.h"
 
-#include "core/Bunny.h"
-
-#include <FL/gl.h>
-
-using namespace fcb::core;
+#include <utility>
 
 namespace fcb { namespace graphics {
 
 
-//! Constructor.
-//! @param[in] gameObject A weak pointer to a bunny game object. The weak pointer is stored for the lifetime of this object.
-ModelBunny::ModelBunny(std::weak_ptr<Bunny> gameObject)
-    : m_gameObject(std::move(gameObject))
-{ }
-
-//! @return True if the referenced game object still exists.
-//!         False if the referenced game object has been destroyed, in which case this object should be destroyed as well.
-bool ModelBunny::DrawIfValid() const
+//! @return An empty batch for drawing bunnies.
+SpeciesBatch ModelBunny::MakeBatch()
 {
-    // Check the referenced game object.
-    std::shared_ptr<Bunny const> const object = m_gameObject.lock();
-    if (!object)
-        return false;
-
-    // Setup the transformation.
-    glPushMatrix();
-    glTranslatef(object->X(), object->Y(), .2f);
-    glScalef(object->Radius(), object->Radius(), 0);
-    float const degrees = object->Angle() * static_cast<float>(180.0 / M_PI);
-    glRotatef(degrees, 0, 0, 1);
+    std::vector<SpeciesBatch::Point> triangles = {
+        { 1,   0 },
+        {-1,  .5f},
+        {-1, -.5f},
+    };
 
     // Color white.
-    glColor3f(1, 1, 1);
-
-    // Draw.
-    glBegin(GL_TRIANGLES);
-    glVertex2f( 1,   0 );
-    glVertex2f(-1,  .5f);
-    glVertex2f(-1, -.5f);
-    glEnd();
-
-    // End transformation.
-    glPopMatrix();
-
-    return true;
+    return SpeciesBatch(std::move(triangles), .2f, { 1, 1, 1 });
 }
 
 
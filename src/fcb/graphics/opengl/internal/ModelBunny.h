@@ -18,13 +18,7 @@
 
 #pragma once
 
-#define _USE_MATH_DEFINES
-#include <cmath>
-#include <memory>
-
-namespace fcb { namespace core {
-    class Bunny;
-} }
+#include "SpeciesBatch.h"
 
 namespace fcb { namespace graphics {
 
@@ -32,12 +26,7 @@ namespace fcb { namespace graphics {
 class ModelBunny
 {
 public:
-    explicit ModelBunny(std::weak_ptr<fcb::core::Bunny> gameObject);
-
-    bool DrawIfValid() const;
-
-private:
-    std::weak_ptr<fcb::core::Bunny> m_gameObject;
+    static SpeciesBatch MakeBatch();
 };
 
 } }
@@ -18,52 +18,26 @@
 
 #include "ModelClover.h"
 
-#include "core/Clover.h"
-
-#include <FL/gl.h>
-
-using namespace fcb::core;
+#include <utility>
 
 namespace fcb { namespace graphics {
 
 
-//! Constructor.
-//! @param[in] gameObject A weak pointer to a clover game object. The weak pointer is stored for the lifetime of this object.
-ModelClover::ModelClover(std::weak_ptr<Clover> gameObject)
-    : m_gameObject(std::move(gameObject))
-{ }
-
-//! @return True if the referenced game object still exists.
-//!         False if the referenced game object has been destroyed, in which case this object should be destroyed as well.
-bool ModelClover::DrawIfValid() const
+//! @return An empty batch for drawing clovers.
+SpeciesBatch ModelClover::MakeBatch()
 {
-    // Check the referenced game object.
-    std::shared_ptr<Clover const> const object = m_gameObject.lock();
-    if (!object)
-        return false;
-
-    // Setup the transformation.
-    glPushMatrix();
-    glTranslatef(object->X(), object->Y(), .1f);
-    glScalef(object->Radius(), object->Radius(), 0);
-    float const degrees = object->Angle() * static_cast<float>(180.0 / M_PI);
-    glRotatef(degrees, 0, 0, 1);
+    // A square, as two triangles.
+    std::vector<SpeciesBatch::Point> triangles = {
+        {-1,  1},
+        {-1, -1},
+        { 1, -1},
+        {-1,  1},
+        { 1, -1},
+        { 1,  1},
+    };
 
     // Color green.
-    glColor3f(0, 0x9F / 256.0f, 0x61 / 256.0f);
-
-    // Draw.
-    glBegin(GL_QUADS);
-    glVertex2f(-1,  1);
-    glVertex2f(-1, -1);
-    glVertex2f( 1, -1);
-    glVertex2f( 1,  1);
-    glEnd();
-
-    // End transformation.
-    glPopMatrix();
-
-    return true;
+    return SpeciesBatch(std::move(triangles), .1f, { 0, 0x9F / 256.0f, 0x61 / 256.0f });
 }
 
 
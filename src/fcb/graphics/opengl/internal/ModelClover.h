@@ -18,13 +18,7 @@
 
 #pragma once
 
-#define _USE_MATH_DEFINES
-#include <cmath>
-#include <memory>
-
-namespace fcb { namespace core {
-    class Clover;
-} }
+#include "SpeciesBatch.h"
 
 namespace fcb { namespace graphics {
 
@@ -32,12 +26,7 @@ namespace fcb { namespace graphics {
 class ModelClover
 {
 public:
-    explicit ModelClover(std::weak_ptr<fcb::core::Clover> gameObject);
-
-    bool DrawIfValid() const;
-
-private:
-    std::weak_ptr<fcb::core::Clover> m_gameObject;
+    static SpeciesBatch MakeBatch();
 };
 
 } }
@@ -18,13 +18,7 @@
 
 #pragma once
 
-#define _USE_MATH_DEFINES
-#include <cmath>
-#include <memory>
-
-namespace fcb { namespace core {
-    class Fox;
-} }
+#include "SpeciesBatch.h"
 
 namespace fcb { namespace graphics {
 
@@ -32,12 +26,7 @@ namespace fcb { namespace graphics {
 class ModelFox
 {
 public:
-    explicit ModelFox(std::weak_ptr<fcb::core::Fox> gameObject);
-
-    bool DrawIfValid() const;
-
-private:
-    std::weak_ptr<fcb::core::Fox> m_gameObject;
+    static SpeciesBatch MakeBatch();
 };
 
 } }
@@ -0,0 +1,116 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "SpeciesBatch.h"
+
+#include <FL/gl.h>
+
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace fcb { namespace graphics {
+
+
+//! Constructor.
+//! @param[in] triangles The shape, in model space: 3 corners per triangle. The model faces +x with a radius of 1.
+//! @param[in] depth     The z-coordinate of the shape. Shapes with a higher depth are drawn on top.
+//! @param[in] color     The color of copies added without one.
+SpeciesBatch::SpeciesBatch(std::vector<Point> triangles, float const depth, Color const color)
+    : m_triangles(std::move(triangles))
+    , m_depth(depth)
+    , m_color(color)
+{
+    assert(m_triangles.size() % 3 == 0);
+}
+
+//! Remove all the copies. Call at the start of each frame.
+void SpeciesBatch::Clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_angle.clear();
+    m_radius.clear();
+    m_colors.clear();
+}
+
+//! Add a copy in the default color.
+//! @param[in] x      The x-coordinate of the copy.
+//! @param[in] y      The y-coordinate of the copy.
+//! @param[in] angle  The orientation of the copy in radians.
+//! @param[in] radius The radius of the copy.
+void SpeciesBatch::Add(float const x, float const y, float const angle, float const radius)
+{
+    Add(x, y, angle, radius, m_color);
+}
+
+//! Add a copy.
+void SpeciesBatch::Add(float const x, float const y, float const angle, float const radius, Color const color)
+{
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_angle.push_back(angle);
+    m_radius.push_back(radius);
+    m_colors.push_back(color);
+}
+
+//! @return The number of copies.
+size_t SpeciesBatch::Size() const
+{
+    return m_x.size();
+}
+
+//! Draw all the copies. Should only be called when OpenGL is ready to draw.
+void SpeciesBatch::Draw()
+{
+    if (m_x.empty())
+        return;
+
+    size_t const numVertices = m_x.size() * m_triangles.size();
+    m_vertexArray.resize(numVertices * 3);
+    m_colorArray.resize(numVertices * 3);
+
+    // The same transformation as translate, scale, then rotate, done on the CPU.
+    float* vertex = m_vertexArray.data();
+    float* color = m_colorArray.data();
+    for (size_t i = 0; i < m_x.size(); ++i)
+    {
+        float const cosine = std::cos(m_angle[i]) * m_radius[i];
+        float const sine   = std::sin(m_angle[i]) * m_radius[i];
+        for (Point const& corner : m_triangles)
+        {
+            *vertex++ = m_x[i] + cosine * corner[0] - sine * corner[1];
+            *vertex++ = m_y[i] + sine * corner[0] + cosine * corner[1];
+            *vertex++ = m_depth;
+            *color++ = m_colors[i].r;
+            *color++ = m_colors[i].g;
+            *color++ = m_colors[i].b;
+        }
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, m_vertexArray.data());
+    glColorPointer(3, GL_FLOAT, 0, m_colorArray.data());
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(numVertices));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+} }
@@ -0,0 +1,71 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace fcb { namespace graphics {
+
+//! Draws every copy of one shape, e.g. one species' sprite, with a single draw call.
+//! Models add a copy (position, orientation, size, color) for each object during a frame.
+//! Draw then transforms the shape for every copy on the CPU into one vertex array and one color array,
+//! and hands both to OpenGL with one glDrawArrays, instead of a push/transform/begin/end/pop sequence per object.
+//! This is not hardware instancing, and the arrays are not in a buffer object. Both need functions newer than OpenGL 1.1,
+//! which Windows only provides through wglGetProcAddress, and the project has no extension loader. So it sticks to 1.1 client-side arrays.
+//! The arrays are kept between frames, so they are only reallocated when the number of copies grows.
+class SpeciesBatch
+{
+public:
+    struct Color
+    {
+        float r;
+        float g;
+        float b;
+    };
+    using Point = std::array<float, 2>;
+
+    SpeciesBatch(std::vector<Point> triangles, float const depth, Color const color);
+
+    void Clear();
+    void Add(float const x, float const y, float const angle, float const radius);
+    void Add(float const x, float const y, float const angle, float const radius, Color const color);
+    size_t Size() const;
+
+    void Draw();
+
+private:
+    std::vector<Point> m_triangles;
+    float m_depth;
+    Color m_color;
+
+    // The copies.
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_angle;
+    std::vector<float> m_radius;
+    std::vector<Color> m_colors;
+
+    // What is handed to OpenGL: x, y, z and r, g, b for each vertex of each copy.
+    std::vector<float> m_vertexArray;
+    std::vector<float> m_colorArray;
+};
+
+} }
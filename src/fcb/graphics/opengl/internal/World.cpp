@@ -34,18 +34,19 @@ World& World::Get()
     return s_world;
 }
 
-//! @return The world's GOM instance.
-GraphicsObjectManager& World::GetGraphicsObjectManager()
-{
-    return m_graphicsObjectManager;
-}
-
 //! Set all the OpenGL setup settings again.
 void World::Refresh()
 {
     m_refresh = true;
 }
 
+//! Draw a snapshot until another is set.
+//! @param[in] snapshot Must stay valid until replaced. nullptr draws an empty world.
+void World::SetSnapshot(fcb::core::WorldSnapshot const* snapshot)
+{
+    m_snapshot = snapshot;
+}
+
 //! Should only be called when OpenGL is ready to draw.
 //! Draws everything.
 void World::draw()
@@ -75,7 +76,7 @@ void World::draw()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Draw all the objects.
-    GraphicsObjectManager::Attorney::Draw(m_graphicsObjectManager);
+    GraphicsObjectManager::Attorney::Draw(m_graphicsObjectManager, m_snapshot);
 }
 
 
@@ -35,9 +35,8 @@ public:
     World& operator=(World const&) = delete;
     World& operator=(World&&)      = delete;
 
-    GraphicsObjectManager& GetGraphicsObjectManager();
-
     void Refresh();
+    void SetSnapshot(fcb::core::WorldSnapshot const* snapshot);
 
 private:
     World() = default;
@@ -48,6 +47,7 @@ private:
     void draw();
 
     bool m_refresh = true;
+    fcb::core::WorldSnapshot const* m_snapshot = nullptr;
     GraphicsObjectManager m_graphicsObjectManager;
 };
 
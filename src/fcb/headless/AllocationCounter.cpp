@@ -0,0 +1,172 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Counts every heap allocation in the process, including the ones Eigen makes with malloc directly, not just operator new.
+// glibc lets a program define its own malloc and friends in place of the library's, and operator new calls them.
+// These count the call, then forward to glibc's own. Elsewhere, nothing is counted.
+// Every function that can hand out a new block is replaced: the aligned ones too, since over-aligned operator new
+// (e.g. for alignas(64) types) goes through aligned_alloc, and Eigen can use posix_memalign.
+
+#if defined(__GLIBC__)
+
+namespace {
+
+    std::atomic<uint64_t> s_numAllocations{ 0 };
+
+}  // Anonymous namespace.
+
+extern "C" {
+
+void* __libc_malloc(size_t size) noexcept;
+void* __libc_calloc(size_t count, size_t size) noexcept;
+void* __libc_realloc(void* pointer, size_t size) noexcept;
+void* __libc_memalign(size_t alignment, size_t size) noexcept;
+void* __libc_valloc(size_t size) noexcept;
+void* __libc_pvalloc(size_t size) noexcept;
+
+void* malloc(size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+
+void* reallocarray(void* pointer, size_t count, size_t size) noexcept
+{
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total))
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(pointer, total);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    // glibc's aligned_alloc is its memalign.
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out_pointer, size_t alignment, size_t size) noexcept
+{
+    // The same checks as glibc's own: a power of two multiple of sizeof(void*).
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0)
+        return EINVAL;
+    void* const pointer = memalign(alignment, size);
+    if (pointer == nullptr)
+        return ENOMEM;
+    *out_pointer = pointer;
+    return 0;
+}
+
+void* valloc(size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_valloc(size);
+}
+
+void* pvalloc(size_t size) noexcept
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_pvalloc(size);
+}
+
+}
+
+#endif
+
+namespace fcb { namespace headless {
+
+
+//! @return true if NumAllocations counts on this platform.
+bool CountsAllocations()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+//! Allocate once each through malloc, over-aligned operator new, and posix_memalign, and check that each one was counted.
+//! A path the counter misses would let a check for allocations pass without looking.
+//! @return false if an allocation went uncounted. Always true if not CountsAllocations.
+bool CountsEveryAllocator()
+{
+#if defined(__GLIBC__)
+    bool counted = true;
+
+    uint64_t before = NumAllocations();
+    std::free(std::malloc(64));
+    counted = counted && NumAllocations() > before;
+
+    // Called directly, not through a new-expression, so the compiler can't leave the allocation out.
+    before = NumAllocations();
+    ::operator delete(::operator new(64, std::align_val_t(64)), std::align_val_t(64));
+    counted = counted && NumAllocations() > before;
+
+    before = NumAllocations();
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, 64, 64) == 0)
+        std::free(pointer);
+    counted = counted && NumAllocations() > before;
+
+    return counted;
+#else
+    return true;
+#endif
+}
+
+//! @return The number of heap allocations the whole process has made so far, on any thread. Always 0 if not CountsAllocations.
+uint64_t NumAllocations()
+{
+#if defined(__GLIBC__)
+    return s_numAllocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+
+} }
@@ -16,17 +16,14 @@
 
 // Language: ISO C++17
 
-#include "graphics/ObjectRegistry.h"
+#pragma once
 
-#include "World.h"
+#include <cstdint>
 
-namespace fcb { namespace graphics {
-
-
-bool RegisterObject(GameObjectPointer gameObject)
-{
-    return World::Get().GetGraphicsObjectManager().RegisterObject(gameObject);
-}
+namespace fcb { namespace headless {
 
+bool CountsAllocations();
+bool CountsEveryAllocator();
+uint64_t NumAllocations();
 
 } }
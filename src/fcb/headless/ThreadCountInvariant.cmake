@@ -0,0 +1,23 @@
+# Runs FcbHeadless with the same seed on 1 thread and on 4, and fails unless the checkpoints they save are byte for byte the same.
+# Enough bunnies and foxes that the thread pool splits them, across the worlds' boundaries too.
+# Usage: cmake -DHEADLESS=<FcbHeadless> -DWORK_DIR=<dir> -P ThreadCountInvariant.cmake
+
+foreach(threads 1 4)
+    execute_process(
+        COMMAND ${HEADLESS} --generations 1 --seed 11 --bunnies 200 --clovers 400 --foxes 200 --replicas 2
+                --threads ${threads} --save ${WORK_DIR}/threads${threads}.ckpt
+        OUTPUT_QUIET
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "FcbHeadless --threads ${threads} failed: ${result}")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK_DIR}/threads1.ckpt ${WORK_DIR}/threads4.ckpt
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "The checkpoints from 1 and 4 threads differ")
+endif()
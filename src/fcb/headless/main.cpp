@@ -0,0 +1,338 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "AllocationCounter.h"
+
+#include "core/Simulation.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::core;
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//! The exit code for a check that can't run here. ctest reports it as skipped.
+int constexpr c_skipped = 77;
+
+//! Command line options.
+struct Options
+{
+    unsigned long numGenerations = 0;  // 0 runs forever.
+    size_t numIslands = 1;
+    std::string savePath;    // Save a checkpoint here after every generation.
+    std::string resumePath;  // Resume from this checkpoint.
+    std::string profilePath; // Time the phases of each generation, and write a trace here.
+    bool checkAllocations = false;          // Fail if a generation allocates after warming up.
+    unsigned long numWarmupGenerations = 0; // Generations allowed to allocate before the check starts.
+    SimulationSettings simulation;
+    ml::IslandModelSettings islands;
+};
+
+char const* const c_usage =
+    "Usage: FcbHeadless [options]\n"
+    "  --generations N         Run N generations. 0 (the default) runs forever.\n"
+    "  --threads N             Use N threads. 0 (the default) uses one per hardware thread.\n"
+    "  --seed N                Seed the run. The same seed gives the same results, whatever the number of threads.\n"
+    "  --bunnies N             Bunnies per population. Default 50.\n"
+    "  --clovers N             Clovers per world. Default 200.\n"
+    "  --foxes N               Foxes per world, hunting the bunnies. Default 0.\n"
+    "  --hidden-activation F   The brains' hidden layer activation: sigmoid (the default), fast-sigmoid, rough-sigmoid,\n"
+    "                          tanh, or relu.\n"
+    "  --output-activation F   The brains' output layer activation. The same choices.\n"
+    "  --replicas R            Score each generation in R worlds with different clovers, and average. Default 1.\n"
+    "  --selection KIND X      How parents are picked: linear X (pressure, 1 to 2), exponential X (base, 0 to 1),\n"
+    "                          or tournament X (size). Default tournament 6.\n"
+    "  --save FILE             Save a checkpoint to FILE after every generation. Not with --islands.\n"
+    "  --resume FILE           Resume from a checkpoint. The seed and population sizes come from the checkpoint.\n"
+    "  --islands K             Evolve K populations side by side, one per thread. Default 1.\n"
+    "  --migration-interval M  With islands, migrate every M generations. Default 10. 0 never migrates.\n"
+    "  --migrants N            With islands, send each island's best N along each route. Default 2.\n"
+    "  --topology ring|star    With islands, which islands send to which. Default ring.\n"
+    "  --profile FILE          Report where each generation's time goes, and write a Chrome trace to FILE as it goes.\n"
+    "  --check-allocations W   Exit with an error if any generation after the first W allocates on the heap. Linux only.\n"
+    "                          Not with --islands.\n";
+
+//! Parse the command line.
+//! @param[in]  argc        From main.
+//! @param[in]  argv        From main.
+//! @param[out] out_options The parsed options. Options not on the command line keep their defaults.
+//! @return false if the command line was bad.
+bool parseOptions(int const argc, char* argv[], Options& out_options)
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            return false;
+        std::string const name = argv[i];
+        char const* const value = argv[i + 1];
+
+        if (name == "--selection")
+        {
+            if (i + 2 >= argc)
+                return false;
+            double const parameter = std::strtod(argv[i + 2], nullptr);
+            if (std::strcmp(value, "linear") == 0)
+                out_options.simulation.selection = ml::SelectionPolicy::LinearRank(parameter);
+            else if (std::strcmp(value, "exponential") == 0)
+                out_options.simulation.selection = ml::SelectionPolicy::ExponentialRank(parameter);
+            else if (std::strcmp(value, "tournament") == 0)
+                out_options.simulation.selection = ml::SelectionPolicy::Tournament(parameter);
+            else
+                return false;
+            ++i;
+            continue;
+        }
+
+        if (name == "--generations")
+            out_options.numGenerations = std::strtoul(value, nullptr, 10);
+        else if (name == "--threads")
+            out_options.simulation.numThreads = std::strtoul(value, nullptr, 10);
+        else if (name == "--seed")
+            out_options.simulation.seed = std::strtoull(value, nullptr, 10);
+        else if (name == "--bunnies")
+            out_options.simulation.numBunnies = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (name == "--clovers")
+            out_options.simulation.numClovers = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (name == "--foxes")
+            out_options.simulation.numFoxes = std::strtoul(value, nullptr, 10);
+        else if (name == "--hidden-activation")
+        {
+            if (!ml::ParseActivation(value, out_options.simulation.activations.hidden))
+                return false;
+        }
+        else if (name == "--output-activation")
+        {
+            if (!ml::ParseActivation(value, out_options.simulation.activations.output))
+                return false;
+        }
+        else if (name == "--replicas")
+            out_options.simulation.numReplicas = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (name == "--save")
+            out_options.savePath = value;
+        else if (name == "--resume")
+            out_options.resumePath = value;
+        else if (name == "--profile")
+            out_options.profilePath = value;
+        else if (name == "--check-allocations")
+        {
+            out_options.checkAllocations = true;
+            out_options.numWarmupGenerations = std::strtoul(value, nullptr, 10);
+        }
+        else if (name == "--islands")
+            out_options.numIslands = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (name == "--migration-interval")
+            out_options.islands.migrationInterval = std::strtoul(value, nullptr, 10);
+        else if (name == "--migrants")
+            out_options.islands.numMigrants = std::strtoul(value, nullptr, 10);
+        else if (name == "--topology" && std::strcmp(value, "ring") == 0)
+            out_options.islands.topology = ml::MigrationTopology::Ring;
+        else if (name == "--topology" && std::strcmp(value, "star") == 0)
+            out_options.islands.topology = ml::MigrationTopology::Star;
+        else
+            return false;
+    }
+    // Checkpoints hold one simulation, and only a single simulation counts its allocations.
+    return out_options.numIslands == 1 || (out_options.savePath.empty() && out_options.resumePath.empty() && !out_options.checkAllocations);
+}
+
+//! @return The time since start in milliseconds.
+double millisecondsSince(Clock::time_point const start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//! Print how many heap allocations each part of a generation made, where they can be counted.
+//! Once a run has warmed up, the cycles shouldn't allocate at all.
+//! @param[in] numBefore        NumAllocations() before the generation.
+//! @param[in] numAfterCycles   NumAllocations() after its cycles.
+//! @param[in] numAfterBreeding NumAllocations() after breeding the next generation.
+void reportAllocations(uint64_t const numBefore, uint64_t const numAfterCycles, uint64_t const numAfterBreeding)
+{
+    if (headless::CountsAllocations())
+        std::cout << "    Heap allocations: " << numAfterCycles - numBefore << " in the cycles, " << numAfterBreeding - numAfterCycles << " breeding" << std::endl;
+}
+
+//! Print where the time went since the last report, if profiling.
+void reportProfile()
+{
+    if (util::Profiler::Get().IsEnabled())
+        util::WriteReport(std::cout, util::Profiler::Get().TakeReport());
+}
+
+//! Run generations of one simulation back to back without drawing or waiting.
+//! @param[in] options How to run.
+//! @return false if the checkpoint couldn't be loaded, or options.checkAllocations is set and a generation allocated after warming up.
+bool runSimulation(Options const& options)
+{
+    Simulation simulation(options.simulation);
+    if (!options.resumePath.empty())
+    {
+        auto const start = Clock::now();
+        if (!simulation.LoadCheckpoint(options.resumePath))
+        {
+            std::cerr << "Could not load checkpoint " << options.resumePath << std::endl;
+            return false;
+        }
+        std::cout << "Resumed from " << options.resumePath << " (seed " << simulation.Seed() << ") in " << millisecondsSince(start) << " ms" << std::endl;
+    }
+
+    bool allocationFree = true;
+    while (options.numGenerations == 0 || simulation.Generation() < options.numGenerations)
+    {
+        unsigned const generation = simulation.Generation();
+        std::cout << "Generation: " << generation << std::endl;
+
+        // Run the current generation.
+        uint64_t const numAllocationsBefore = headless::NumAllocations();
+        auto const start = Clock::now();
+        simulation.RunGeneration();
+        double const cycleTime = millisecondsSince(start);
+        uint64_t const numAllocationsAfterCycles = headless::NumAllocations();
+
+        // Rank the bunnies and create the next generation.
+        unsigned const foxTopScore = simulation.FoxTopScore();
+        unsigned const topScore = simulation.NextGeneration();
+        double const generationTime = millisecondsSince(start);
+        uint64_t const numAllocationsAfterBreeding = headless::NumAllocations();
+
+        std::cout << "    Bunny top score: " << topScore << std::endl;
+        if (simulation.NumFoxes() > 0)
+            std::cout << "    Fox top score: " << foxTopScore << std::endl;
+        std::cout << "    Wall time: " << generationTime << " ms"
+                  << " (" << Simulation::CyclesPerGeneration() * 1000.0 / cycleTime << " cycles/s)" << std::endl;
+        reportAllocations(numAllocationsBefore, numAllocationsAfterCycles, numAllocationsAfterBreeding);
+        reportProfile();
+        if (options.checkAllocations && generation >= options.numWarmupGenerations && numAllocationsAfterBreeding != numAllocationsBefore)
+        {
+            std::cerr << "Generation " << generation << " allocated " << numAllocationsAfterBreeding - numAllocationsBefore << " times after warming up" << std::endl;
+            allocationFree = false;
+        }
+
+        if (!options.savePath.empty() && !simulation.SaveCheckpoint(options.savePath))
+            std::cerr << "Could not save checkpoint " << options.savePath << std::endl;
+    }
+    return allocationFree;
+}
+
+//! Run generations of several simulations side by side, with migration.
+//! Each island steps its bunnies on one thread. The islands are spread over the threads.
+//! @param[in] options How to run.
+void runArchipelago(Options const& options)
+{
+    std::vector<std::unique_ptr<Simulation>> islands;
+    for (size_t i = 0; i < options.numIslands; ++i)
+    {
+        SimulationSettings settings = options.simulation;
+        settings.numThreads = 1;
+        // Give each island its own seed, derived from the run's seed.
+        util::Philox4x32 rng(options.simulation.seed, static_cast<uint32_t>(i));
+        settings.seed = (uint64_t(rng()) << 32) | rng();
+        islands.push_back(std::make_unique<Simulation>(settings));
+    }
+
+    ml::IslandModelSettings islandSettings = options.islands;
+    islandSettings.numThreads = options.simulation.numThreads;
+    Archipelago archipelago(std::move(islands), islandSettings);
+
+    while (options.numGenerations == 0 || archipelago.Generation() < options.numGenerations)
+    {
+        std::cout << "Generation: " << archipelago.Generation() << std::endl;
+
+        auto const start = Clock::now();
+        std::vector<unsigned> const topScores = archipelago.RunGeneration();
+        double const generationTime = millisecondsSince(start);
+
+        std::cout << "    Bunny top score: " << *std::max_element(topScores.begin(), topScores.end()) << std::endl;
+        std::cout << "    Island top scores:";
+        for (unsigned const topScore : topScores)
+            std::cout << " " << topScore;
+        std::cout << std::endl;
+        std::cout << "    Wall time: " << generationTime << " ms"
+                  << " (" << static_cast<double>(options.numIslands) * Simulation::CyclesPerGeneration() * 1000.0 / generationTime << " cycles/s)" << std::endl;
+        reportProfile();
+    }
+}
+
+}  // Anonymous namespace.
+
+
+//! Trains without a GUI, as fast as the CPU allows. See c_usage for the options.
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << c_usage;
+        return 1;
+    }
+    std::cout << "Seed: " << options.simulation.seed << std::endl;
+    if (options.checkAllocations && !headless::CountsAllocations())
+    {
+        std::cerr << "Can't count allocations on this platform" << std::endl;
+        return c_skipped;
+    }
+    if (options.checkAllocations && !headless::CountsEveryAllocator())
+    {
+        std::cerr << "Some heap allocations aren't being counted" << std::endl;
+        return 1;
+    }
+
+    // Each generation's report also appends its phases to the trace, so a run of any length keeps a bounded amount in memory.
+    std::ofstream trace;
+    if (!options.profilePath.empty())
+    {
+        trace.open(options.profilePath);
+        if (!trace)
+        {
+            std::cerr << "Could not write trace " << options.profilePath << std::endl;
+            return 1;
+        }
+        util::Profiler::Get().Enable(&trace);
+    }
+
+    bool succeeded = true;
+    if (options.numIslands > 1)
+        runArchipelago(options);
+    else
+        succeeded = runSimulation(options);
+
+    if (!options.profilePath.empty())
+    {
+        util::Profiler::Get().Disable();
+        if (!trace)
+        {
+            std::cerr << "Could not write trace " << options.profilePath << std::endl;
+            return 1;
+        }
+    }
+
+    return succeeded ? 0 : 1;
+}
@@ -18,13 +18,21 @@
 
 #pragma once
 
+#include <atomic>
+
 namespace fcb { namespace input {
 
 //! An interface for sharing user input state between the main program and the GUI.
+//! Atomic, so threads other than the GUI's can read it.
 struct InputState
 {
-    bool exit = false;
-    bool fastForward = false;
+    static unsigned constexpr c_uncapped = 0;           // The speed for running as fast as possible.
+    static unsigned constexpr c_maxSpeed = 128;         // The fastest capped speed. One step faster is uncapped.
+    static unsigned constexpr c_maxCyclesPerDraw = 1024;
+
+    std::atomic<bool> exit { false };
+    std::atomic<unsigned> speed { 1 };          // How many times faster than real time to run the simulation, or c_uncapped.
+    std::atomic<unsigned> cyclesPerDraw { 1 };  // Only hand every this many cycles to the display.
 };
 
 //! Get the graphics system's input state.
@@ -21,8 +21,32 @@
 
 #include <FL/Fl.H>
 
+#include <algorithm>
+
 namespace fcb { namespace input {
 
+namespace {
+
+//! @param[in] speed The current speed.
+//! @return The next faster speed step. Doubles, up to c_maxSpeed, then uncapped.
+unsigned faster(unsigned const speed)
+{
+    if (speed == InputState::c_uncapped || speed >= InputState::c_maxSpeed)
+        return InputState::c_uncapped;
+    return speed * 2;
+}
+
+//! @param[in] speed The current speed.
+//! @return The next slower speed step. Halves, down to real time.
+unsigned slower(unsigned const speed)
+{
+    if (speed == InputState::c_uncapped)
+        return InputState::c_maxSpeed;
+    return std::max(speed / 2, 1u);
+}
+
+}  // Anonymous namespace.
+
 
 InputState& GetInputState()
 {
@@ -51,10 +75,45 @@ int ProcessFltkInputEvent(int event)
         }
 
         // Space.
-        // Fast-forward.
+        // Toggle between uncapped and the last capped speed.
         if (Fl::event_key() == ' ')
         {
-            inputState.fastForward = !inputState.fastForward;
+            static unsigned s_lastCappedSpeed = 1;
+            if (inputState.speed == InputState::c_uncapped)
+            {
+                inputState.speed = s_lastCappedSpeed;
+            }
+            else
+            {
+                s_lastCappedSpeed = inputState.speed;
+                inputState.speed = InputState::c_uncapped;
+            }
+            return 1;
+        }
+
+        // + and -.
+        // Step the speed up or down.
+        if (Fl::event_key() == '=' || Fl::event_key() == FL_KP + '+')
+        {
+            inputState.speed = faster(inputState.speed);
+            return 1;
+        }
+        if (Fl::event_key() == '-' || Fl::event_key() == FL_KP + '-')
+        {
+            inputState.speed = slower(inputState.speed);
+            return 1;
+        }
+
+        // [ and ].
+        // Draw more or fewer of the cycles.
+        if (Fl::event_key() == ']')
+        {
+            inputState.cyclesPerDraw = std::min(inputState.cyclesPerDraw * 2, InputState::c_maxCyclesPerDraw);
+            return 1;
+        }
+        if (Fl::event_key() == '[')
+        {
+            inputState.cyclesPerDraw = std::max(inputState.cyclesPerDraw / 2, 1u);
             return 1;
         }
     }
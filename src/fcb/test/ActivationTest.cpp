@@ -0,0 +1,108 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include "ml/Activation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::ml;
+
+
+namespace {
+
+//! @return z from -100 to 100 in small steps, and a few huge values. An odd count, so every instruction set has a padded tail packet.
+std::vector<float> inputs()
+{
+    std::vector<float> values;
+    for (int i = -1000000; i <= 1000000; ++i)
+        values.push_back(static_cast<float>(i) * 1e-4f);
+    for (float const huge : { -1e30f, -1000.0f, 1000.0f, 1e30f })
+        values.push_back(huge);
+    if (values.size() % 2 == 0)
+        values.push_back(0.5f);
+    return values;
+}
+
+//! Check one function on one instruction set against a reference, value by value.
+//! @param[in] reference The reference for each input.
+//! @param[in] tolerance The documented bound on the absolute error.
+void checkAgainst(InstructionSet const instructionSet, char const* setName, Activation const activation,
+                  std::vector<float> const& input, std::vector<float> const& reference, float const tolerance)
+{
+    std::vector<float> values = input;
+    if (!ActivateWith(instructionSet, activation, values.data(), values.size()))
+    {
+        // Not in this build. The scalar path always is.
+        FCB_CHECK(instructionSet != InstructionSet::Scalar, "the scalar path must always be built");
+        return;
+    }
+
+    float worst = 0;
+    size_t worstIndex = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        float const error = std::abs(values[i] - reference[i]);
+        if (!(error <= worst))  // Also catches NaN.
+        {
+            worst = error;
+            worstIndex = i;
+        }
+    }
+    FCB_CHECK(worst <= tolerance, std::string(setName) + " " + ActivationName(activation) + ": error " + std::to_string(worst)
+                                  + " at z = " + std::to_string(input[worstIndex]));
+}
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! The vectorized activation functions stay within their documented error on every instruction set the build has.
+void Activations()
+{
+    std::vector<float> const input = inputs();
+
+    // The references: the plain Sigmoid, tanh from the C library, and max.
+    std::vector<float> sigmoid = input;
+    Activate(Activation::Sigmoid, sigmoid.data(), sigmoid.size());
+    std::vector<float> tanh(input.size());
+    std::transform(input.begin(), input.end(), tanh.begin(), [](float const z) { return std::tanh(z); });
+    std::vector<float> relu(input.size());
+    std::transform(input.begin(), input.end(), relu.begin(), [](float const z) { return std::max(z, 0.0f); });
+
+    struct NamedSet
+    {
+        InstructionSet instructionSet;
+        char const* name;
+    };
+    for (NamedSet const set : { NamedSet{ InstructionSet::Scalar, "scalar" }, NamedSet{ InstructionSet::Sse2, "SSE2" }, NamedSet{ InstructionSet::Avx2, "AVX2" } })
+    {
+        // The bounds in Activation.h.
+        checkAgainst(set.instructionSet, set.name, Activation::FastSigmoid, input, sigmoid, 2e-7f);
+        checkAgainst(set.instructionSet, set.name, Activation::Tanh, input, tanh, 2e-7f);
+        checkAgainst(set.instructionSet, set.name, Activation::Relu, input, relu, 0);
+    }
+}
+
+} }
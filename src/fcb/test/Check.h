@@ -0,0 +1,42 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <string>
+
+// The checks each test makes. A failed check is reported and counted, and the test carries on, so one run shows every failure.
+
+namespace fcb { namespace test {
+
+void Fail(char const* file, int const line, std::string const& message);
+unsigned NumFailures();
+
+// The tests. See main.cpp for their names.
+void RankSelection();
+void Checkpoint();
+void Activations();
+void BruteForceSearch();
+void GridSearch();
+
+} }
+
+//! Check a condition. If it is false, report it along with a message that says what was being checked.
+//! The message is only built if the check fails. It can be anything that converts to std::string.
+#define FCB_CHECK(condition, message) \
+    ((condition) ? static_cast<void>(0) : ::fcb::test::Fail(__FILE__, __LINE__, std::string(#condition) + ": " + std::string(message)))
@@ -0,0 +1,160 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include "core/Simulation.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::core;
+
+
+namespace {
+
+unsigned constexpr c_numGenerations = 4;
+
+//! A small run with everything a checkpoint holds: bunnies, clovers, foxes, and replicas to clone from them.
+SimulationSettings settings(uint64_t const seed)
+{
+    SimulationSettings settings;
+    settings.numBunnies = 50;
+    settings.numClovers = 200;
+    settings.numFoxes = 10;
+    settings.numReplicas = 2;
+    settings.numThreads = 1;
+    settings.seed = seed;
+    return settings;
+}
+
+//! @return The bytes of a file. Empty if it can't be read.
+std::vector<char> readFile(std::string const& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+//! Overwrite a file with the given bytes.
+void writeFile(std::string const& path, std::vector<char> const& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+//! @return The checkpoint the simulation would save now.
+std::vector<char> checkpointOf(Simulation const& simulation, std::string const& path)
+{
+    FCB_CHECK(simulation.SaveCheckpoint(path), path);
+    return readFile(path);
+}
+
+void runGenerations(Simulation& simulation, unsigned const numGenerations)
+{
+    for (unsigned i = 0; i < numGenerations; ++i)
+    {
+        simulation.RunGeneration();
+        simulation.NextGeneration();
+    }
+}
+
+//! Stopping halfway, saving, and loading into another simulation ends up in the same place as running straight through.
+void checkResume()
+{
+    Simulation straight(settings(5));
+    runGenerations(straight, c_numGenerations);
+    std::vector<char> const expected = checkpointOf(straight, "CheckpointTest.straight.ckpt");
+
+    Simulation first(settings(5));
+    runGenerations(first, c_numGenerations / 2);
+    FCB_CHECK(first.SaveCheckpoint("CheckpointTest.half.ckpt"), "saving halfway");
+
+    // A different seed and sizes, all of which the checkpoint replaces.
+    SimulationSettings other = settings(6);
+    other.numBunnies = 20;
+    other.numClovers = 100;
+    other.numFoxes = 3;
+    Simulation resumed(other);
+    FCB_CHECK(resumed.LoadCheckpoint("CheckpointTest.half.ckpt"), "loading halfway");
+    FCB_CHECK(resumed.Generation() == c_numGenerations / 2, "generation after loading: " + std::to_string(resumed.Generation()));
+    FCB_CHECK(resumed.Seed() == 5, "seed after loading");
+    runGenerations(resumed, c_numGenerations - c_numGenerations / 2);
+
+    FCB_CHECK(checkpointOf(resumed, "CheckpointTest.resumed.ckpt") == expected, "resumed run differs from the straight run");
+}
+
+//! Expect a load to fail and leave the simulation as it was.
+void checkRejected(Simulation& simulation, std::vector<char> const& before, std::string const& path, std::string const& what)
+{
+    FCB_CHECK(!simulation.LoadCheckpoint(path), what);
+    FCB_CHECK(checkpointOf(simulation, "CheckpointTest.after.ckpt") == before, what + " changed the simulation");
+}
+
+//! Missing, truncated, and foreign files are rejected without touching the simulation.
+void checkRejection()
+{
+    Simulation source(settings(7));
+    runGenerations(source, 1);
+    std::vector<char> const good = checkpointOf(source, "CheckpointTest.good.ckpt");
+    FCB_CHECK(good.size() > 1, "checkpoint size");
+
+    Simulation simulation(settings(8));
+    runGenerations(simulation, 1);
+    std::vector<char> const before = checkpointOf(simulation, "CheckpointTest.before.ckpt");
+
+    checkRejected(simulation, before, "CheckpointTest.missing.ckpt", "missing file");
+
+    // Cut the file short all the way through, including just one byte short.
+    size_t const step = std::max<size_t>(good.size() / 200, 1);
+    std::vector<size_t> lengths;
+    for (size_t length = 0; length < good.size(); length += step)
+        lengths.push_back(length);
+    lengths.push_back(good.size() - 1);
+    for (size_t const length : lengths)
+    {
+        writeFile("CheckpointTest.truncated.ckpt", std::vector<char>(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(length)));
+        checkRejected(simulation, before, "CheckpointTest.truncated.ckpt", "truncated to " + std::to_string(length) + " bytes");
+    }
+
+    std::vector<char> wrongMagic = good;
+    wrongMagic[0] = 'X';
+    writeFile("CheckpointTest.magic.ckpt", wrongMagic);
+    checkRejected(simulation, before, "CheckpointTest.magic.ckpt", "wrong magic");
+
+    // The untouched file still loads, so the failures above were down to the damage.
+    FCB_CHECK(simulation.LoadCheckpoint("CheckpointTest.good.ckpt"), "loading the undamaged file");
+    FCB_CHECK(checkpointOf(simulation, "CheckpointTest.after.ckpt") == good, "round trip");
+}
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! Simulation::SaveCheckpoint and LoadCheckpoint resume runs exactly, and reject damaged files.
+void Checkpoint()
+{
+    checkResume();
+    checkRejection();
+}
+
+} }
@@ -0,0 +1,199 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "core/MovingGrid.h"
+#include "core/NearestNeighbor.h"
+#include "core/SpatialGrid.h"
+#include "util/Rng.h"
+#include "util/ThreadPool.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::core;
+
+
+namespace {
+
+//! Points as separate x and y arrays, the way the indexes take them.
+struct Points
+{
+    std::vector<float> x;
+    std::vector<float> y;
+
+    void Add(float const px, float const py)
+    {
+        x.push_back(px);
+        y.push_back(py);
+    }
+    size_t Size() const { return x.size(); }
+};
+
+//! @return Points spread uniformly over the world.
+Points randomPoints(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> dist(Globals::c_worldLeftBound, Globals::c_worldRightBound);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+        points.Add(dist(rng), dist(rng));
+    return points;
+}
+
+//! @return Points on a lattice with `perUnit` points per unit of distance, so the same point turns up many times over and many
+//! points are equally far from a query. With 16 per unit the lattice lines up with the cell edges of grids with a power of 2 cells
+//! per side. With 3 or 7 per unit it lines up with the edges of a 6 or 14 cell grid only after rounding, which leaves items that tie the
+//! best at exactly the searched radius one ring further out, where the ring search decides whether to stop.
+Points latticePoints(size_t const count, int const perUnit, util::Philox4x32& rng)
+{
+    std::uniform_int_distribution<int> dist(-perUnit, perUnit - 1);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+        points.Add(static_cast<float>(dist(rng)) / static_cast<float>(perUnit), static_cast<float>(dist(rng)) / static_cast<float>(perUnit));
+    return points;
+}
+
+//! @return Points within a cell's width of the world's edges, including exactly on them, where the grid wraps around.
+Points edgePoints(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> distAlong(Globals::c_worldLeftBound, Globals::c_worldRightBound);
+    std::uniform_real_distribution<float> distIn(0, 0.1f);
+    std::uniform_int_distribution<int> distSide(0, 4);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float const along = distAlong(rng);
+        switch (distSide(rng))
+        {
+        case 0:  points.Add(Globals::c_worldLeftBound + distIn(rng), along); break;
+        case 1:  points.Add(Globals::c_worldRightBound - distIn(rng), along); break;
+        case 2:  points.Add(along, Globals::c_worldBottomBound + distIn(rng)); break;
+        case 3:  points.Add(along, Globals::c_worldTopBound - distIn(rng)); break;
+        default: points.Add(i % 2 ? Globals::c_worldRightBound : Globals::c_worldLeftBound, along); break;
+        }
+    }
+    return points;
+}
+
+//! @return Queries of every kind: random, on the lattices and between their points, near and on the edges, and on the items themselves.
+//! Every point of the sixths and fourteenths lattices is a query, so the ties the thirds and sevenths lattices set up are always found.
+Points queriesFor(Points const& items, util::Philox4x32& rng)
+{
+    Points queries = randomPoints(64, rng);
+    Points const lattice = latticePoints(64, 16, rng);
+    Points const edges = edgePoints(64, rng);
+    for (size_t i = 0; i < 64; ++i)
+    {
+        queries.Add(lattice.x[i], lattice.y[i]);
+        queries.Add(lattice.x[i] + 1.0f / 32, lattice.y[i] + 1.0f / 32);
+        queries.Add(edges.x[i], edges.y[i]);
+    }
+    for (int const perUnit : { 6, 14 })
+    {
+        for (int column = -perUnit; column < perUnit; ++column)
+        {
+            for (int row = -perUnit; row < perUnit; ++row)
+                queries.Add(static_cast<float>(column) / static_cast<float>(perUnit), static_cast<float>(row) / static_cast<float>(perUnit));
+        }
+    }
+    for (size_t i = 0; i < items.Size(); i += items.Size() / 16 + 1)
+        queries.Add(items.x[i], items.y[i]);
+    return queries;
+}
+
+//! Check one answer against NearestBruteForce, which checks every item and gives ties to the lowest index.
+void checkAnswer(Points const& items, float const x, float const y, size_t const found, std::string const& what)
+{
+    size_t const expected = NearestBruteForce(x, y, items.x.data(), items.y.data(), items.Size());
+    std::string const where = what + ", " + std::to_string(items.Size()) + " items, query (" + std::to_string(x) + ", " + std::to_string(y) + ")";
+    FCB_CHECK(found < items.Size(), where + ": index " + std::to_string(found) + " out of range");
+    if (found >= items.Size())
+        return;
+    float const expectedDistance = DistanceSquared(x, y, items.x[expected], items.y[expected]);
+    float const foundDistance = DistanceSquared(x, y, items.x[found], items.y[found]);
+    FCB_CHECK(foundDistance == expectedDistance, where + ": distance squared " + std::to_string(foundDistance) + ", expected " + std::to_string(expectedDistance));
+    FCB_CHECK(found == expected, where + ": index " + std::to_string(found) + ", expected " + std::to_string(expected));
+}
+
+//! Check both grids against brute force on one set of items.
+void checkGrids(Points const& items, util::ThreadPool& threadPool, util::Philox4x32& rng, std::string const& what)
+{
+    SpatialGrid spatialGrid(SpatialGrid::CellsPerSideFor(items.Size()));
+    for (size_t i = 0; i < items.Size(); ++i)
+        spatialGrid.Insert(i, items.x[i], items.y[i]);
+    MovingGrid movingGrid;
+    movingGrid.Rebuild(items.x.data(), items.y.data(), items.Size(), threadPool);
+
+    Points const queries = queriesFor(items, rng);
+    std::vector<size_t> batch(queries.Size());
+    spatialGrid.Nearest(queries.x.data(), queries.y.data(), queries.Size(), batch.data());
+    for (size_t q = 0; q < queries.Size(); ++q)
+    {
+        checkAnswer(items, queries.x[q], queries.y[q], spatialGrid.Nearest(queries.x[q], queries.y[q]), what + ", SpatialGrid");
+        checkAnswer(items, queries.x[q], queries.y[q], batch[q], what + ", SpatialGrid batched");
+        checkAnswer(items, queries.x[q], queries.y[q], movingGrid.Nearest(queries.x[q], queries.y[q]), what + ", MovingGrid");
+    }
+
+    // Move half the items, so SpatialGrid's cells are rearranged by Move rather than filled in order.
+    Points moved = items;
+    Points const destinations = randomPoints(items.Size(), rng);
+    for (size_t i = 0; i < items.Size(); i += 2)
+    {
+        moved.x[i] = destinations.x[i];
+        moved.y[i] = destinations.y[i];
+        spatialGrid.Move(i, moved.x[i], moved.y[i]);
+    }
+    for (size_t q = 0; q < queries.Size(); ++q)
+        checkAnswer(moved, queries.x[q], queries.y[q], spatialGrid.Nearest(queries.x[q], queries.y[q]), what + ", SpatialGrid after moves");
+}
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! SpatialGrid and MovingGrid find the same item as checking every item, index for index, ties to the lowest index.
+//! Covers the small counts where the grids fall back to checking every item, counts on both sides of SpatialGrid's batched
+//! fallback, and enough items for MovingGrid to split its rebuild across threads.
+void GridSearch()
+{
+    util::Philox4x32 rng(4);
+    util::ThreadPool threadPool(4);
+
+    std::vector<size_t> counts;
+    for (size_t count = 1; count <= 20; ++count)
+        counts.push_back(count);
+    for (size_t const count : { 50, 72, 128, 200, 392, 512, 513, 1000, 2048, 3000, 10000 })
+        counts.push_back(count);
+
+    for (size_t const count : counts)
+    {
+        checkGrids(randomPoints(count, rng), threadPool, rng, "random");
+        checkGrids(latticePoints(count, 16, rng), threadPool, rng, "lattice");
+        checkGrids(latticePoints(count, 3, rng), threadPool, rng, "lattice of thirds");
+        checkGrids(latticePoints(count, 7, rng), threadPool, rng, "lattice of sevenths");
+        checkGrids(edgePoints(count, rng), threadPool, rng, "edges");
+    }
+}
+
+} }
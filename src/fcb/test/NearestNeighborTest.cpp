@@ -0,0 +1,199 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include "core/Geometry.h"
+#include "core/Globals.h"
+#include "core/NearestNeighbor.h"
+#include "util/Rng.h"
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::core;
+
+
+namespace {
+
+//! Points as separate x and y arrays, the way the searches take them.
+struct Points
+{
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+//! @return Points spread uniformly over the world.
+Points randomPoints(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> dist(Globals::c_worldLeftBound, Globals::c_worldRightBound);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+    {
+        points.x.push_back(dist(rng));
+        points.y.push_back(dist(rng));
+    }
+    return points;
+}
+
+//! @return Points on a lattice with a spacing of 1/4, so distances between them and the cell centers are exact and ties are everywhere:
+//! the same point many times over, and several points equally far from a query, some of them the other way around the world.
+Points latticePoints(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_int_distribution<int> dist(-4, 3);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+    {
+        points.x.push_back(static_cast<float>(dist(rng)) / 4);
+        points.y.push_back(static_cast<float>(dist(rng)) / 4);
+    }
+    return points;
+}
+
+//! @return Points on a lattice with a spacing of 1/7, which floats can't hold exactly, so equal distances only come out equal
+//! if every search rounds them the same way.
+Points seventhsPoints(size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_int_distribution<int> dist(-7, 6);
+    Points points;
+    for (size_t i = 0; i < count; ++i)
+    {
+        points.x.push_back(static_cast<float>(dist(rng)) / 7);
+        points.y.push_back(static_cast<float>(dist(rng)) / 7);
+    }
+    return points;
+}
+
+//! @return Pairs of points at (x + a, y + b) and (x + b, y + a) from a query, in either order, each pair with its own random offsets.
+//! Rounded separately, a*a + b*b and b*b + a*a are the same float, but fused into a multiply-add they can differ by an ulp,
+//! so the pairs tie only if the distances are never contracted.
+Points mirroredPoints(float const x, float const y, size_t const count, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> dist(-0.4f, 0.4f);
+    Points points;
+    for (size_t i = 0; i + 1 < count; i += 2)
+    {
+        float const a = dist(rng);
+        float const b = dist(rng);
+        points.x.push_back(x + a);
+        points.y.push_back(y + b);
+        points.x.push_back(x + b);
+        points.y.push_back(y + a);
+    }
+    if (count % 2)
+    {
+        points.x.push_back(x + 0.5f);
+        points.y.push_back(y + 0.5f);
+    }
+    return points;
+}
+
+//! The plain loop: every point in index order, keeping the first of equally near points.
+size_t nearestScalar(float const x, float const y, Points const& points)
+{
+    size_t best = 0;
+    float bestDistanceSquared = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < points.x.size(); ++i)
+    {
+        float const distanceSquared = DistanceSquared(x, y, points.x[i], points.y[i]);
+        if (distanceSquared < bestDistanceSquared)
+        {
+            bestDistanceSquared = distanceSquared;
+            best = i;
+        }
+    }
+    return best;
+}
+
+//! Check the single and the batched search against the plain loop for every query.
+void checkQueries(Points const& points, Points const& queries, std::string const& what)
+{
+    std::vector<size_t> batch(queries.x.size());
+    NearestBruteForce(queries.x.data(), queries.y.data(), queries.x.size(), points.x.data(), points.y.data(), points.x.size(), batch.data());
+
+    for (size_t q = 0; q < queries.x.size(); ++q)
+    {
+        size_t const expected = nearestScalar(queries.x[q], queries.y[q], points);
+        size_t const single = NearestBruteForce(queries.x[q], queries.y[q], points.x.data(), points.y.data(), points.x.size());
+        std::string const where = what + ", " + std::to_string(points.x.size()) + " points, query " + std::to_string(q)
+                                  + ": expected " + std::to_string(expected);
+        FCB_CHECK(single == expected, where + ", single " + std::to_string(single));
+        FCB_CHECK(batch[q] == expected, where + ", batched " + std::to_string(batch[q]));
+    }
+}
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! NearestBruteForce finds the same point as a plain scalar loop, index for index, including the lowest index among ties,
+//! for counts that leave a partial packet at the end and counts that span several tiles of points.
+//! The seventhsPoints and mirroredPoints ties only hold if the loop's DistanceSquared rounds exactly as the vector search does,
+//! which optimized builds break by fusing it into a multiply-add unless the build turns that off.
+void BruteForceSearch()
+{
+    util::Philox4x32 rng(3);
+
+    // Lattice points and the centers between them, which are equally far from up to 4 lattice points.
+    Points latticeQueries;
+    for (int i = -4; i < 4; ++i)
+    {
+        for (int j = -4; j < 4; ++j)
+        {
+            for (float const offset : { 0.0f, 0.125f })
+            {
+                latticeQueries.x.push_back(static_cast<float>(i) / 4 + offset);
+                latticeQueries.y.push_back(static_cast<float>(j) / 4 + offset);
+            }
+        }
+    }
+
+    // Every point of the lattice of fourteenths, which includes the sevenths and the centers between them.
+    Points seventhsQueries;
+    for (int i = -14; i < 14; ++i)
+    {
+        for (int j = -14; j < 14; ++j)
+        {
+            seventhsQueries.x.push_back(static_cast<float>(i) / 14);
+            seventhsQueries.y.push_back(static_cast<float>(j) / 14);
+        }
+    }
+
+    std::vector<size_t> counts;
+    for (size_t count = 1; count <= 40; ++count)
+        counts.push_back(count);
+    for (size_t const count : { 63, 64, 65, 1023, 1024, 1025, 2047, 2049, 3001 })
+        counts.push_back(count);
+
+    for (size_t const count : counts)
+    {
+        checkQueries(randomPoints(count, rng), randomPoints(64, rng), "random");
+        checkQueries(latticePoints(count, rng), latticeQueries, "lattice");
+        checkQueries(seventhsPoints(count, rng), seventhsQueries, "sevenths");
+
+        // One query per set, with the points mirrored about it, so nearly every pair is a tie.
+        Points const mirrorQuery = randomPoints(1, rng);
+        checkQueries(mirroredPoints(mirrorQuery.x[0], mirrorQuery.y[0], count, rng), mirrorQuery, "mirrored");
+    }
+}
+
+} }
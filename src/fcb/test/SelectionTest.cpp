@@ -0,0 +1,168 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include "ml/AliasTable.h"
+#include "ml/GeneticAlgorithmPairing.h"
+#include "util/Rng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace fcb;
+using namespace fcb::ml;
+
+
+namespace {
+
+size_t constexpr c_numSamples = 400000;
+
+//! The policies under test, with a name for the messages.
+struct NamedPolicy
+{
+    char const* name;
+    SelectionPolicy policy;
+};
+
+NamedPolicy const c_policies[] = {
+    { "linear 1.5",        SelectionPolicy::LinearRank(1.5) },
+    { "linear 2",          SelectionPolicy::LinearRank(2) },
+    { "exponential 0.9",   SelectionPolicy::ExponentialRank(0.9) },
+    { "exponential 1e-6",  SelectionPolicy::ExponentialRank(1e-6) },  // Reaches the 1e-300 floor long before rank 1000.
+    { "tournament 1",      SelectionPolicy::Tournament(1) },
+    { "tournament 6",      SelectionPolicy::Tournament(6) },
+};
+
+//! @return Where the check failed, for the messages.
+std::string where(char const* policyName, size_t const n, size_t const rank)
+{
+    return std::string(policyName) + ", n = " + std::to_string(n) + ", rank " + std::to_string(rank);
+}
+
+//! @return How far a frequency measured over c_numSamples draws may stray from its probability: 5 standard deviations, and a little for rounding.
+double tolerance(double const probability)
+{
+    return 5 * std::sqrt(probability * (1 - probability) / static_cast<double>(c_numSamples)) + 1e-9;
+}
+
+//! Every policy gives a distribution over the ranks that favors the better ranks.
+void checkWeights()
+{
+    for (NamedPolicy const& named : c_policies)
+    {
+        for (size_t const n : { size_t(1), size_t(2), size_t(50), size_t(1000) })
+        {
+            std::vector<double> const weights = RankWeights(named.policy, n);
+            FCB_CHECK(weights.size() == n, where(named.name, n, 0));
+            double const sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+            FCB_CHECK(std::abs(sum - 1) < 1e-12, where(named.name, n, 0) + ", sum " + std::to_string(sum));
+            for (size_t rank = 0; rank < n; ++rank)
+            {
+                FCB_CHECK(weights[rank] >= 0, where(named.name, n, rank));
+                // Up to rounding: the tournament weights are differences of powers, so equal weights can come out a few ulps apart.
+                if (rank > 0)
+                    FCB_CHECK(weights[rank] <= weights[rank - 1] * (1 + 1e-12), where(named.name, n, rank));
+            }
+        }
+    }
+
+    // The floor keeps every rank possible, however far down, instead of underflowing to 0.
+    std::vector<double> const steep = RankWeights(SelectionPolicy::ExponentialRank(1e-6), 1000);
+    FCB_CHECK(steep.back() > 0, "exponential 1e-6, n = 1000, last rank");
+}
+
+//! The analytic tournament weights match the frequencies of actually holding tournaments.
+void checkTournament()
+{
+    size_t constexpr n = 50;
+    for (size_t const size : { size_t(1), size_t(2), size_t(6) })
+    {
+        std::vector<double> const weights = RankWeights(SelectionPolicy::Tournament(static_cast<double>(size)), n);
+
+        util::Philox4x32 rng(1, static_cast<uint32_t>(size));
+        std::uniform_int_distribution<size_t> distRank(0, n - 1);
+        std::vector<size_t> wins(n, 0);
+        for (size_t sample = 0; sample < c_numSamples; ++sample)
+        {
+            // The best of `size` uniform picks, with replacement. Rank 0 is the best.
+            size_t winner = n;
+            for (size_t pick = 0; pick < size; ++pick)
+                winner = std::min(winner, distRank(rng));
+            ++wins[winner];
+        }
+
+        for (size_t rank = 0; rank < n; ++rank)
+        {
+            double const frequency = static_cast<double>(wins[rank]) / static_cast<double>(c_numSamples);
+            FCB_CHECK(std::abs(frequency - weights[rank]) <= tolerance(weights[rank]),
+                      "tournament " + std::to_string(size) + ", rank " + std::to_string(rank)
+                      + ": held " + std::to_string(frequency) + ", analytic " + std::to_string(weights[rank]));
+        }
+    }
+}
+
+//! Sampling an AliasTable picks each index about as often as its weight says.
+void checkAliasTable()
+{
+    for (NamedPolicy const& named : c_policies)
+    {
+        for (size_t const n : { size_t(1), size_t(2), size_t(50) })
+        {
+            std::vector<double> const weights = RankWeights(named.policy, n);
+            AliasTable const table(weights);
+            FCB_CHECK(table.Size() == n, where(named.name, n, 0));
+
+            util::Philox4x32 rng(2, static_cast<uint32_t>(n));
+            std::vector<size_t> counts(n, 0);
+            for (size_t sample = 0; sample < c_numSamples; ++sample)
+            {
+                size_t const index = table.Sample(rng);
+                FCB_CHECK(index < n, where(named.name, n, index));
+                if (index < n)
+                    ++counts[index];
+            }
+
+            for (size_t rank = 0; rank < n; ++rank)
+            {
+                double const frequency = static_cast<double>(counts[rank]) / static_cast<double>(c_numSamples);
+                FCB_CHECK(std::abs(frequency - weights[rank]) <= tolerance(weights[rank]),
+                          where(named.name, n, rank) + ": sampled " + std::to_string(frequency) + ", weight " + std::to_string(weights[rank]));
+            }
+        }
+    }
+}
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! RankWeights turns each selection policy into a distribution over the ranks, and AliasTable samples from it faithfully.
+void RankSelection()
+{
+    checkWeights();
+    checkTournament();
+    checkAliasTable();
+}
+
+} }
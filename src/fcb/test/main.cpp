@@ -0,0 +1,102 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "Check.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace fcb;
+
+
+namespace {
+
+//! A test that can be run by name.
+struct Test
+{
+    char const* name;
+    void (*run)();
+};
+
+Test const c_tests[] = {
+    { "RankSelection",    &test::RankSelection },
+    { "Checkpoint",       &test::Checkpoint },
+    { "Activations",      &test::Activations },
+    { "BruteForceSearch", &test::BruteForceSearch },
+    { "GridSearch",       &test::GridSearch },
+};
+
+unsigned s_numFailures = 0;
+
+}  // Anonymous namespace.
+
+
+namespace fcb { namespace test {
+
+//! Report a failed check.
+//! @param[in] file    The source file of the check.
+//! @param[in] line    The line of the check.
+//! @param[in] message What was being checked.
+void Fail(char const* file, int const line, std::string const& message)
+{
+    std::cerr << file << ":" << line << ": check failed: " << message << std::endl;
+    ++s_numFailures;
+}
+
+//! @return The number of checks that have failed so far.
+unsigned NumFailures()
+{
+    return s_numFailures;
+}
+
+} }
+
+
+//! Runs the tests named on the command line, or every test if none are named.
+//! @return 0 if every check passed.
+int main(int argc, char* argv[])
+{
+    bool ranAll = true;
+    for (Test const& test : c_tests)
+    {
+        bool named = (argc == 1);
+        for (int i = 1; i < argc; ++i)
+            named = named || std::strcmp(argv[i], test.name) == 0;
+        if (!named)
+            continue;
+
+        unsigned const numFailuresBefore = test::NumFailures();
+        test.run();
+        std::cout << test.name << ": " << (test::NumFailures() == numFailuresBefore ? "passed" : "FAILED") << std::endl;
+    }
+
+    // Don't let a typo pass as a test that ran.
+    for (int i = 1; i < argc; ++i)
+    {
+        bool known = false;
+        for (Test const& test : c_tests)
+            known = known || std::strcmp(argv[i], test.name) == 0;
+        if (!known)
+        {
+            std::cerr << "No test named " << argv[i] << std::endl;
+            ranAll = false;
+        }
+    }
+
+    return (ranAll && test::NumFailures() == 0) ? 0 : 1;
+}
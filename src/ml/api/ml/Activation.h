@@ -0,0 +1,60 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fcb { namespace ml {
+
+//! An activation function for the nodes of a layer.
+enum class Activation : uint8_t
+{
+    Sigmoid,       // 1 / (1 + e^-z), with the C library's expf, one value at a time. The default.
+    FastSigmoid,   // The same curve with a vectorized polynomial e^-z. Within 2e-7 of Sigmoid, but not bit-identical.
+    RoughSigmoid,  // 0.5 + 0.5 z / (1 + |z|). A cheaper S curve with the same range and centre, but steeper at 0 with longer tails. No exp.
+    Tanh,          // tanh(z), using the same vectorized e^z as FastSigmoid. Within 2e-7. Ranges from -1 to 1.
+    Relu           // max(z, 0).
+};
+
+//! The number of Activation values.
+size_t constexpr c_numActivations = 5;
+
+//! The activation function of each layer of a network.
+struct Activations
+{
+    Activation hidden = Activation::Sigmoid;
+    Activation output = Activation::Sigmoid;
+};
+
+//! The instruction sets the vectorized activation functions can run on. Activate uses the widest one the build targets.
+enum class InstructionSet : uint8_t
+{
+    Scalar,  // One value at a time. Always available.
+    Sse2,    // 4 values at a time.
+    Avx2     // 8 values at a time.
+};
+
+void Activate(Activation const activation, float* values, size_t const count);
+bool ActivateWith(InstructionSet const instructionSet, Activation const activation, float* values, size_t const count);
+
+char const* ActivationName(Activation const activation);
+bool ParseActivation(char const* name, Activation& out_activation);
+
+} }
@@ -0,0 +1,53 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace fcb { namespace ml {
+
+//! Samples indexes with given weights in constant time, using Vose's alias method.
+//! Building the table is O(n). Each sample is then one uniform index plus one biased coin flip,
+//! instead of a linear scan of a "pie chart".
+class AliasTable
+{
+public:
+    explicit AliasTable(std::vector<double> const& weights);
+
+    size_t Size() const;
+
+    //! @param[in] rng The random number generator to draw from.
+    //! @return An index, chosen with probability proportional to its weight.
+    template <typename URBG>
+    size_t Sample(URBG& rng) const
+    {
+        std::uniform_int_distribution<size_t> distColumn(0, m_probability.size() - 1);
+        std::uniform_real_distribution<double> distCoin(0, 1);
+        size_t const column = distColumn(rng);
+        return (distCoin(rng) < m_probability[column]) ? column : m_alias[column];
+    }
+
+private:
+    std::vector<double> m_probability;  // The chance of keeping each column instead of taking its alias.
+    std::vector<size_t> m_alias;
+};
+
+} }
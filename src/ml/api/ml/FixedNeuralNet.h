@@ -0,0 +1,173 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "ml/Activation.h"
+#include "ml/WeightOperations.h"
+#include "util/Util.h"
+
+#include <Eigen/Dense>
+
+namespace fcb { namespace ml {
+
+//! A neural network with 1 hidden layer whose size is known at compile time.
+//! Same design as NeuralNet, but the weights are fixed-size Eigen matrices:
+//! they are stored inline (no heap allocations), the products are unrolled, and FeedForward does not allocate.
+//! Use NeuralNet when the topology is only known at runtime.
+template <int Inputs, int Hidden, int Outputs>
+class FixedNeuralNet
+{
+public:
+    // static consts
+    static int constexpr NUM_INPUTS  = Inputs;
+    static int constexpr NUM_HIDDEN  = Hidden;
+    static int constexpr NUM_OUTPUTS = Outputs;
+    static int constexpr GENOME_SIZE = (Inputs + 1) * Hidden + (Hidden + 1) * Outputs;  // Every weight, input->hidden then hidden->output.
+
+    //! Manages indexing operations to avoid the bias node.
+    struct InputHelper
+    {
+        InputHelper() { m_input(0) = 1; }  // 1 for bias.
+        float  operator()(Eigen::Index index) const { return m_input(index + 1); }
+        float& operator()(Eigen::Index index)       { return m_input(index + 1); }
+        Eigen::Matrix<float, 1, Inputs + 1> m_input;
+    };
+
+    // public typedefs
+    using InputType         = InputHelper;
+    using OutputType        = Eigen::Matrix<float, 1, Outputs>;
+    using InputWeightsType  = Eigen::Matrix<float, Inputs + 1, Hidden>;   // input->hidden, with a bias row.
+    using OutputWeightsType = Eigen::Matrix<float, Hidden + 1, Outputs>;  // hidden->output, with a bias row.
+
+    // public functions
+    FixedNeuralNet();
+
+    Activations GetActivations() const;
+    void SetActivations(Activations const activations);
+
+    template <typename URBG>
+    void Randomize(URBG& rng);
+    Eigen::VectorXf Genome() const;
+    void SetGenome(Eigen::VectorXf const& genome);
+
+    void FeedForward(InputType const& inputs, OutputType& out_outputs) const;
+    template <typename URBG>
+    static void Crossover(FixedNeuralNet const& m, FixedNeuralNet const& f, FixedNeuralNet& out_c, URBG& rng);
+
+private:
+    // private data
+    InputWeightsType  m_inputWeights;
+    OutputWeightsType m_outputWeights;
+    Activations       m_activations;
+};
+
+
+//! Constructor.
+//! The weights and bias start at 0. See Randomize, SetGenome, and Crossover.
+template <int Inputs, int Hidden, int Outputs>
+FixedNeuralNet<Inputs, Hidden, Outputs>::FixedNeuralNet()
+    : m_inputWeights(InputWeightsType::Zero())
+    , m_outputWeights(OutputWeightsType::Zero())
+{ }
+
+//! Set the weights and bias randomly.
+//! @param[in] rng The random number generator to draw from.
+template <int Inputs, int Hidden, int Outputs>
+template <typename URBG>
+void FixedNeuralNet<Inputs, Hidden, Outputs>::Randomize(URBG& rng)
+{
+    std::uniform_real_distribution<float> distribution(-0.8f, 0.8f);
+    m_inputWeights  = InputWeightsType::NullaryExpr([&distribution, &rng]() { return distribution(rng); });
+    m_outputWeights = OutputWeightsType::NullaryExpr([&distribution, &rng]() { return distribution(rng); });
+}
+
+//! @return A copy of every weight, laid out as NeuralNetPopulation lays out a genome.
+template <int Inputs, int Hidden, int Outputs>
+Eigen::VectorXf FixedNeuralNet<Inputs, Hidden, Outputs>::Genome() const
+{
+    Eigen::VectorXf genome(GENOME_SIZE);
+    genome << Eigen::Map<Eigen::VectorXf const>(m_inputWeights.data(), m_inputWeights.size()),
+              Eigen::Map<Eigen::VectorXf const>(m_outputWeights.data(), m_outputWeights.size());
+    return genome;
+}
+
+//! Overwrite every weight.
+//! @param[in] genome The weights, as Genome returns them. Must be GENOME_SIZE long.
+template <int Inputs, int Hidden, int Outputs>
+void FixedNeuralNet<Inputs, Hidden, Outputs>::SetGenome(Eigen::VectorXf const& genome)
+{
+    if (genome.size() != GENOME_SIZE)
+    {
+        assert(false);
+        return;
+    }
+    Eigen::Map<Eigen::VectorXf>(m_inputWeights.data(), m_inputWeights.size()) = genome.head(m_inputWeights.size());
+    Eigen::Map<Eigen::VectorXf>(m_outputWeights.data(), m_outputWeights.size()) = genome.tail(m_outputWeights.size());
+}
+
+//! @return The activation function of each layer.
+template <int Inputs, int Hidden, int Outputs>
+Activations FixedNeuralNet<Inputs, Hidden, Outputs>::GetActivations() const
+{
+    return m_activations;
+}
+
+//! Change the activation function of each layer. Doesn't touch the weights.
+//! @param[in] activations The functions.
+template <int Inputs, int Hidden, int Outputs>
+void FixedNeuralNet<Inputs, Hidden, Outputs>::SetActivations(Activations const activations)
+{
+    m_activations = activations;
+}
+
+//! Feed the input forward and return the outputs.
+//! @param[in]  inputs  A vector of input values.
+//! @param[out] outputs A vector to hold output results.
+template <int Inputs, int Hidden, int Outputs>
+void FixedNeuralNet<Inputs, Hidden, Outputs>::FeedForward(InputType const& inputs, OutputType& out_outputs) const
+{
+    // The bias must be set to 1.
+    assert(inputs.m_input(0) == 1);
+    // A place on the stack to hold the activation of input->hidden layer. The bias is the first element.
+    Eigen::Matrix<float, 1, Hidden + 1> hiddenActivation;
+    hiddenActivation(0) = 1;
+    hiddenActivation.template tail<Hidden>() = inputs.m_input * m_inputWeights;
+    Activate(m_activations.hidden, hiddenActivation.data() + 1, Hidden);
+
+    // Activate hidden->output layer.
+    out_outputs = hiddenActivation * m_outputWeights;
+    Activate(m_activations.output, out_outputs.data(), Outputs);
+}
+
+//! Combine the weights from two neural nets to make a new one.
+//! @param[in]  m     Parent one.
+//! @param[in]  f     Parent two. Can be the same.
+//! @param[out] out_c A neural net to write the results to.
+//! @param[in]  rng   The random number generator to draw from.
+template <int Inputs, int Hidden, int Outputs>
+template <typename URBG>
+void FixedNeuralNet<Inputs, Hidden, Outputs>::Crossover(FixedNeuralNet const& m, FixedNeuralNet const& f, FixedNeuralNet& out_c, URBG& rng)
+{
+    detail::crossoverMatrix(m.m_inputWeights,  f.m_inputWeights,  out_c.m_inputWeights, rng);
+    detail::crossoverMatrix(m.m_outputWeights, f.m_outputWeights, out_c.m_outputWeights, rng);
+    detail::mutateMatrix(out_c.m_inputWeights, rng);
+    detail::mutateMatrix(out_c.m_outputWeights, rng);
+}
+
+} }
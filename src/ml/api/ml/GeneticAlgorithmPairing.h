@@ -18,14 +18,41 @@
 
 #pragma once
 
+#include "ml/AliasTable.h"
+#include "util/Rng.h"
+
 #include <cassert>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace fcb { namespace ml {
 
+//! How likely each rank is to be picked as a parent. Every policy is a distribution over ranks,
+//! so it is turned into an AliasTable once per generation and each pick is O(1) for any population size.
+struct SelectionPolicy
+{
+    enum class Kind
+    {
+        LinearRank,       // Weight falls linearly with rank. parameter: the expected number of picks of the best, s in [1, 2]. The worst gets 2 - s.
+        ExponentialRank,  // Weight of rank r is c^r. parameter: the base c in (0, 1). Lower is greedier.
+        Tournament        // Pick the best of k uniformly chosen individuals. parameter: the tournament size k >= 1.
+    };
+
+    static SelectionPolicy LinearRank(double const pressure)  { return { Kind::LinearRank, pressure }; }
+    static SelectionPolicy ExponentialRank(double const base) { return { Kind::ExponentialRank, base }; }
+    static SelectionPolicy Tournament(double const size)      { return { Kind::Tournament, size }; }
+
+    Kind kind;
+    double parameter;
+};
+
+std::vector<double> RankWeights(SelectionPolicy const& policy, size_t const populationSize);
+
 size_t selectIndex20();
 size_t selectIndex50();
 float breedFloat(float const f_m, float const f_f);
+float breedFloat(float const f_m, float const f_f, util::Philox4x32& rng);
 
 //! Fixed breeding based on rank.
 //! Population size must be 20.
@@ -114,4 +141,68 @@ void BreedPopChance50(std::vector<T> const& pop, std::vector<T>& out_pop, Crosso
     }
 }
 
+//! Select parents randomly, with higher ranks given a higher selection chance according to a policy.
+//! Works for any population size.
+//! Note that a parent can breed with itself.
+//! @param pop[in]      The current generation, ranked best first. Must not be empty.
+//! @param out_pop[out] Pre-allocated vector for the next generation. Must be a different collection than pop. Can be a different size.
+//! @param crossover[in] A callable that performs chromosome crossover. Signature must be (T const& m, T const& f, T& out_c) -> void.
+//! @param policy[in]   How likely each rank is to be picked.
+template <typename T, typename CrossoverFunctor>
+void BreedPopChance(std::vector<T> const& pop, std::vector<T>& out_pop, CrossoverFunctor&& crossover, SelectionPolicy const& policy)
+{
+    if (&pop == &out_pop || pop.empty())
+    {
+        assert(false);
+        return;
+    }
+
+    AliasTable const parents(RankWeights(policy, pop.size()));
+    for (auto& out_p : out_pop)
+    {
+        size_t const mIndex = parents.Sample(util::rng());
+        size_t const fIndex = parents.Sample(util::rng());
+        crossover(pop[mIndex], pop[fIndex], out_p);
+    }
+}
+
+//! Same as above, but each child draws from its own random number stream, so a child doesn't depend on its siblings
+//! and the children can be bred in any order, or in parallel.
+//! @param pop[in]         The current generation, ranked best first. Must not be empty.
+//! @param out_pop[out]    Pre-allocated vector for the next generation. Must be a different collection than pop. Can be a different size.
+//! @param rngForChild[in] A callable that returns the stream for a child. Signature must be (size_t childIndex) -> util::Philox4x32.
+//! @param crossover[in]   A callable that performs chromosome crossover. Signature must be (T const& m, T const& f, T& out_c, util::Philox4x32& rng) -> void.
+//! @param policy[in]      How likely each rank is to be picked.
+template <typename T, typename RngFactory, typename CrossoverFunctor>
+void BreedPopChance(std::vector<T> const& pop, std::vector<T>& out_pop, RngFactory&& rngForChild, CrossoverFunctor&& crossover, SelectionPolicy const& policy)
+{
+    if (&pop == &out_pop || pop.empty())
+    {
+        assert(false);
+        return;
+    }
+
+    BreedPopChance(pop, out_pop, std::forward<RngFactory>(rngForChild), std::forward<CrossoverFunctor>(crossover), AliasTable(RankWeights(policy, pop.size())));
+}
+
+//! Same as above, but with the policy already turned into an AliasTable, e.g. to build it once and reuse it every generation.
+//! @param parents[in] The chance of picking each rank. Must be the same size as pop.
+template <typename T, typename RngFactory, typename CrossoverFunctor>
+void BreedPopChance(std::vector<T> const& pop, std::vector<T>& out_pop, RngFactory&& rngForChild, CrossoverFunctor&& crossover, AliasTable const& parents)
+{
+    if (&pop == &out_pop || pop.empty() || parents.Size() != pop.size())
+    {
+        assert(false);
+        return;
+    }
+
+    for (size_t c = 0; c < out_pop.size(); ++c)
+    {
+        util::Philox4x32 rng = rngForChild(c);
+        size_t const mIndex = parents.Sample(rng);
+        size_t const fIndex = parents.Sample(rng);
+        crossover(pop[mIndex], pop[fIndex], out_pop[c], rng);
+    }
+}
+
 } }
@@ -0,0 +1,193 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace fcb { namespace ml {
+
+//! Which islands send migrants to which.
+enum class MigrationTopology
+{
+    Ring,  // Island i sends to island i + 1. The last sends to the first.
+    Star   // Island 0 is the hub. Every other island sends to the hub, and the hub sends to every other island.
+};
+
+//! A route migrants take from one island to another.
+struct MigrationRoute
+{
+    size_t from;
+    size_t to;
+};
+
+//! @param[in] topology   The shape of the network of islands.
+//! @param[in] numIslands The number of islands.
+//! @return Every route in the network.
+inline std::vector<MigrationRoute> MigrationRoutes(MigrationTopology const topology, size_t const numIslands)
+{
+    std::vector<MigrationRoute> routes;
+    if (numIslands < 2)
+        return routes;
+
+    switch (topology)
+    {
+    case MigrationTopology::Ring:
+        for (size_t i = 0; i < numIslands; ++i)
+            routes.push_back({ i, (i + 1) % numIslands });
+        break;
+    case MigrationTopology::Star:
+        for (size_t i = 1; i < numIslands; ++i)
+        {
+            routes.push_back({ i, 0 });
+            routes.push_back({ 0, i });
+        }
+        break;
+    }
+    return routes;
+}
+
+//! Settings for an IslandModel.
+struct IslandModelSettings
+{
+    size_t migrationInterval = 10;                       // Migrate every this many generations. 0 never migrates.
+    size_t numMigrants = 2;                              // How many of its best each island sends along each route.
+    MigrationTopology topology = MigrationTopology::Ring;
+    size_t numThreads = 0;                               // Threads to run the islands on. 0 uses one per hardware thread.
+};
+
+//! An island-model genetic algorithm.
+//! Several populations (islands) evolve independently, each on its own thread.
+//! Every few generations, each island's best individuals migrate along the routes of a topology,
+//! replacing the worst individuals of the island they arrive at. The islands stay diverse, but good genes still spread.
+//!
+//! The Island type must provide:
+//!   - Island::Individual: a copy of one individual, including its score.
+//!   - void RunGeneration(): Evaluate the current generation.
+//!   - std::vector<size_t> Rank() const: The indexes of the current generation, best first.
+//!   - Individual Emigrate(size_t index) const: Copy an individual out.
+//!   - void Immigrate(size_t index, Individual const& individual): Overwrite an individual.
+//!   - unsigned NextGeneration(): Breed the next generation. Returns the top score of the one that ended.
+//!
+//! The islands don't share state, and migration happens between generations on the calling thread,
+//! so the results depend only on the islands, not on the number of threads.
+template <typename Island>
+class IslandModel
+{
+public:
+    //! Constructor.
+    //! @param[in] islands  The islands. Should have their own seeds, or they will all evolve the same way.
+    //! @param[in] settings How to run the islands and when to migrate.
+    IslandModel(std::vector<std::unique_ptr<Island>> islands, IslandModelSettings const& settings)
+        : m_islands(std::move(islands))
+        , m_settings(settings)
+        , m_routes(MigrationRoutes(settings.topology, m_islands.size()))
+        , m_threadPool(settings.numThreads)
+    { }
+
+    //! @return The number of islands.
+    size_t NumIslands() const
+    {
+        return m_islands.size();
+    }
+
+    //! @return One of the islands.
+    Island& GetIsland(size_t const index)
+    {
+        return *m_islands[index];
+    }
+    Island const& GetIsland(size_t const index) const
+    {
+        return *m_islands[index];
+    }
+
+    //! @return The number of the current generation, starting at 0.
+    unsigned Generation() const
+    {
+        return m_generation;
+    }
+
+    //! Evaluate the current generation on every island, migrate if it is time, then breed the next generation.
+    //! @return The top score of each island in the generation that just ended.
+    std::vector<unsigned> RunGeneration()
+    {
+        m_threadPool.ParallelFor(m_islands.size(), 1, [this](size_t const begin, size_t const end) {
+            for (size_t i = begin; i < end; ++i)
+                m_islands[i]->RunGeneration();
+        });
+
+        ++m_generation;
+        if (m_settings.migrationInterval > 0 && m_generation % m_settings.migrationInterval == 0)
+            migrate();
+
+        std::vector<unsigned> topScores(m_islands.size());
+        m_threadPool.ParallelFor(m_islands.size(), 1, [this, &topScores](size_t const begin, size_t const end) {
+            for (size_t i = begin; i < end; ++i)
+                topScores[i] = m_islands[i]->NextGeneration();
+        });
+        return topScores;
+    }
+
+private:
+    //! Send each island's best along every route, replacing the worst of the island they arrive at.
+    //! All the migrants leave before any arrive, so a migrant moves at most one hop per migration.
+    void migrate()
+    {
+        std::vector<std::vector<size_t>> rankings;
+        rankings.reserve(m_islands.size());
+        for (auto const& island : m_islands)
+            rankings.push_back(island->Rank());
+
+        // Gather the emigrants.
+        std::vector<std::vector<typename Island::Individual>> emigrants(m_islands.size());
+        for (size_t i = 0; i < m_islands.size(); ++i)
+        {
+            size_t const numMigrants = std::min(m_settings.numMigrants, rankings[i].size());
+            for (size_t rank = 0; rank < numMigrants; ++rank)
+                emigrants[i].push_back(m_islands[i]->Emigrate(rankings[i][rank]));
+        }
+
+        // Replace the worst, working up from the bottom. Never replace the top half, so a busy hub keeps its own best.
+        std::vector<size_t> numReplaced(m_islands.size(), 0);
+        for (auto const& route : m_routes)
+        {
+            auto const& ranking = rankings[route.to];
+            for (auto const& immigrant : emigrants[route.from])
+            {
+                if (numReplaced[route.to] >= ranking.size() / 2)
+                    break;
+                size_t const worst = ranking[ranking.size() - 1 - numReplaced[route.to]];
+                m_islands[route.to]->Immigrate(worst, immigrant);
+                ++numReplaced[route.to];
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Island>> m_islands;
+    IslandModelSettings m_settings;
+    std::vector<MigrationRoute> m_routes;
+    util::ThreadPool m_threadPool;
+    unsigned m_generation = 0;
+};
+
+} }
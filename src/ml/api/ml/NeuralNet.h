@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include <array>
+#include "ml/Activation.h"
 
 #include <Eigen/Dense>
 
@@ -38,31 +38,39 @@ public:
         InputHelper() { m_input(0) = 1; }  // 1 for bias.
         float  operator()(Eigen::Index index) const { return m_input(index + 1); }
         float& operator()(Eigen::Index index)       { return m_input(index + 1); }
-        Eigen::RowVectorXf m_input = Eigen::RowVectorXf(NeuralNet::NUM_INPUTS + 1);
+        Eigen::Matrix<float, 1, NUM_INPUTS + 1> m_input;  // Fixed size, so making one doesn't allocate.
     };
 
     // public typedefs
-    using InputType         = InputHelper;
-    using OutputType        = Eigen::Matrix<float, 1, NUM_OUTPUTS>;
-    using WeightsType       = Eigen::MatrixXf;
-    using WeightsCollection = std::array<WeightsType, 2>;
+    using InputType   = InputHelper;
+    using OutputType  = Eigen::Matrix<float, 1, NUM_OUTPUTS>;
+    using WeightsType = Eigen::MatrixXf;
 
     // public functions
-    NeuralNet() = default;
+    NeuralNet();
     explicit NeuralNet(unsigned const numHidden);
+    NeuralNet(NeuralNet const& other);
+    NeuralNet& operator=(NeuralNet other);
+    void Swap(NeuralNet& other);
+
+    Activations GetActivations() const;
+    void SetActivations(Activations const activations);
 
     void FeedForward(InputType const& inputs, OutputType& out_outputs) const;
     static void Crossover(NeuralNet const& m, NeuralNet const& f, NeuralNet& out_c);
 
 private:
+    using WeightsMap = Eigen::Map<WeightsType>;
+
     // private functions
-    WeightsCollection generateWeightsRandom() const;
-    WeightsCollection generateWeightsZero() const;
+    void mapWeights();
 
     // private data
-    unsigned          m_numHidden = 6;
-    WeightsCollection m_weights   = generateWeightsRandom();
-    WeightsCollection m_dWeights  = generateWeightsZero();
+    unsigned        m_numHidden = 6;
+    Eigen::VectorXf m_genome;         // Every weight in one block: input->hidden, then hidden->output. The same layout as a NeuralNetPopulation genome.
+    WeightsMap      m_inputWeights;   // input->hidden, with a bias row. A view into m_genome.
+    WeightsMap      m_outputWeights;  // hidden->output, with a bias row. A view into m_genome.
+    Activations     m_activations;
 };
 
 } }
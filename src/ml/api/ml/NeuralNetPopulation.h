@@ -0,0 +1,101 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "ml/Activation.h"
+#include "ml/NeuralNet.h"
+#include "util/Rng.h"
+
+#include <Eigen/Dense>
+
+#include <istream>
+#include <ostream>
+
+namespace fcb { namespace ml {
+
+//! The brains of a whole population. Every network has the same topology as NeuralNet.
+//! All the weights live in one packed block (an arena), one network's genome after another,
+//! so sweeping the population reads memory front to back.
+//! Each genome is the input->hidden weights followed by the hidden->output weights, both column-major.
+//! A second arena holds the next generation while it is bred, so breeding never overwrites a parent that is still needed.
+//! Moving on to the next generation swaps the two arenas' pointers.
+class NeuralNetPopulation
+{
+public:
+    //! Inputs for the whole population, one row per network.
+    //! Manages indexing operations to avoid the bias column, like NeuralNet::InputHelper.
+    struct InputBatchHelper
+    {
+        explicit InputBatchHelper(size_t const size = 0) { Resize(size); }
+        void Resize(size_t const size) { m_input.resize(static_cast<Eigen::Index>(size), Eigen::NoChange); m_input.col(0).setOnes(); }  // 1 for bias.
+        float  operator()(size_t const row, Eigen::Index index) const { return m_input(static_cast<Eigen::Index>(row), index + 1); }
+        float& operator()(size_t const row, Eigen::Index index)       { return m_input(static_cast<Eigen::Index>(row), index + 1); }
+        Eigen::Matrix<float, Eigen::Dynamic, NeuralNet::NUM_INPUTS + 1, Eigen::RowMajor> m_input;
+    };
+
+    using InputType       = NeuralNet::InputType;
+    using OutputType      = NeuralNet::OutputType;
+    using InputBatchType  = InputBatchHelper;
+    using OutputBatchType = Eigen::Matrix<float, Eigen::Dynamic, NeuralNet::NUM_OUTPUTS, Eigen::RowMajor>;  // One row per network.
+    using HiddenBatchType = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;          // Scratch space for the hidden layer. See HiddenBatch.
+
+    NeuralNetPopulation(size_t const size, unsigned const numHidden);
+
+    size_t Size() const;
+    Eigen::Index GenomeSize() const;
+    unsigned NumHidden() const;
+    HiddenBatchType HiddenBatch() const;
+    Activations GetActivations() const;
+    void SetActivations(Activations const activations);
+
+    Eigen::VectorXf Genome(size_t const index) const;
+    void SetGenome(size_t const index, Eigen::VectorXf const& genome);
+    void Randomize(size_t const index, util::Philox4x32& rng);
+
+    void FeedForward(size_t const index, InputType const& inputs, OutputType& out_outputs) const;
+    void FeedForward(InputBatchType const& inputs, OutputBatchType& out_outputs) const;
+    void FeedForward(InputBatchType const& inputs, OutputBatchType& out_outputs, HiddenBatchType& scratch, size_t const begin, size_t const end) const;
+    void Save(std::ostream& out) const;
+    bool Load(std::istream& in);
+
+    void BreedChild(size_t const m, size_t const f, size_t const c, util::Philox4x32& rng);
+    void NextGeneration();
+
+    static void Crossover(NeuralNetPopulation const& parents, size_t const m, size_t const f, NeuralNetPopulation& out_children, size_t const c, util::Philox4x32& rng);
+
+private:
+    using ConstWeightsMap = Eigen::Map<NeuralNet::WeightsType const>;
+    using WeightsMap      = Eigen::Map<NeuralNet::WeightsType>;
+
+    ConstWeightsMap inputWeights(size_t const index) const;
+    ConstWeightsMap outputWeights(size_t const index) const;
+    WeightsMap inputWeights(size_t const index);
+    WeightsMap outputWeights(size_t const index);
+    WeightsMap childInputWeights(size_t const index);
+    WeightsMap childOutputWeights(size_t const index);
+
+    static void breed(NeuralNetPopulation const& parents, size_t const m, size_t const f, WeightsMap childInput, WeightsMap childOutput, util::Philox4x32& rng);
+
+    unsigned m_numHidden;
+    Activations m_activations;  // Shared by every network.
+    Eigen::MatrixXf m_genomes;      // The current generation. One column per network.
+    Eigen::MatrixXf m_nextGenomes;  // The arena BreedChild writes the next generation into. The same shape.
+};
+
+} }
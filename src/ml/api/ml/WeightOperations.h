@@ -0,0 +1,137 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include "ml/Activation.h"
+#include "util/Util.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Operations on weight matrices shared by the neural net classes.
+// The matrices can be owned (e.g. Eigen::MatrixXf) or views into a larger block (Eigen::Map).
+
+namespace fcb { namespace ml { namespace detail {
+
+    //! Force the sigmoid function to be inlined by writing it as a lambda.
+    inline auto const sigmoid = [](float const z) -> float { return (1.0f / (1.0f + expf(-z))); };
+
+    //! Combine the weights from two matrices into one.
+    //! Copy the weights from one, occasionally switching to the other.
+    //! Uses the array view of the matrices.
+    //! @param[in]  m     Parent one.
+    //! @param[in]  f     Parent two.
+    //! @param[out] out_c A matrix to write the results to. Should be the same dimensions.
+    //! @param[in]  rng   Optional. The random number generator to draw from. Defaults to the global one.
+    template <typename DerivedM, typename DerivedF, typename DerivedC, typename URBG = util::Rng::Generator>
+    void crossoverMatrix(Eigen::MatrixBase<DerivedM> const& m, Eigen::MatrixBase<DerivedF> const& f, Eigen::MatrixBase<DerivedC>& out_c, URBG& rng = util::rng())
+    {
+        double constexpr crossoverRate = 0.7;
+
+        // sanity check. Matrices should have the same shape... but they at least need to have the same number of elements.
+        assert(m.array().size() == f.array().size() && f.array().size() == out_c.array().size());
+
+        std::uniform_real_distribution<> distReal(0, 1);
+        std::uniform_int_distribution<Eigen::Index> distInt(0, out_c.size());
+
+        // Generate some crossover points. Each thread reuses its buffer, so breeding doesn't allocate once it has grown.
+        // The number of points has no upper bound, so a fixed-capacity array would have to either cap it, changing which children are bred,
+        // or overflow. In practice the buffer stops growing after the first few generations.
+        thread_local std::vector<Eigen::Index> t_crossoverPoints;
+        std::vector<Eigen::Index>& crossoverPoints = t_crossoverPoints;
+        crossoverPoints.assign({ 0, out_c.size() });
+        while (distReal(rng) < crossoverRate)
+            crossoverPoints.push_back(distInt(rng));
+        std::sort(crossoverPoints.begin(), crossoverPoints.end());
+
+        // 50% chance to pick either parent to start.
+        bool useM = (distReal(rng) < .5);
+
+        for (size_t i = 0; i < crossoverPoints.size() - 1; ++i)
+        {
+            // Pick a parent and make a pointer to the beginning of its range.
+            float const* const parentBegin = (useM ? m.derived().data() : f.derived().data());
+            // Switch parent for next time.
+            useM = !useM;
+
+            // Setup transcription range given indexes.
+            float const* const first = crossoverPoints[i]     + parentBegin;
+            float const* const last  = crossoverPoints[i + 1] + parentBegin;
+            float* const cIter       = crossoverPoints[i]     + out_c.derived().data();
+
+            // Transcribe.
+            std::copy(first, last, cIter);
+        }
+    }
+
+    //! Chance to mutate a matrix.
+    //! To mutate, add a value between -1 and 1 to 0 or more random weights.
+    //! Uses the array view of the matrix.
+    //! @param[in/out] c   The matrix with a chance to mutate.
+    //! @param[in]     rng Optional. The random number generator to draw from. Defaults to the global one.
+    template <typename Derived, typename URBG = util::Rng::Generator>
+    void mutateMatrix(Eigen::MatrixBase<Derived>& c, URBG& rng = util::rng())
+    {
+        double constexpr mutationRate = .15;
+
+        std::uniform_real_distribution<> distRoll(0, 1);
+        std::uniform_real_distribution<float> distMutation(-.5f, .5f);
+
+        while (distRoll(rng) < mutationRate)
+        {
+            size_t const mutationColumn = rng() % c.cols();
+            c.col(mutationColumn) = c.col(mutationColumn).unaryExpr([&distMutation, &rng](float const in) -> float { return in + distMutation(rng); });
+        }
+    }
+
+    //! Feed one row of inputs forward through a network with 1 hidden layer, without allocating.
+    //! The hidden layer is worked through a block of nodes at a time, in a buffer on the stack,
+    //! and each block's share of the outputs is added up as it goes.
+    //! @param[in]  inputs        The inputs, with a 1 for the bias first.
+    //! @param[in]  inputWeights  The input->hidden weights, with a bias row.
+    //! @param[in]  outputWeights The hidden->output weights, with a bias row.
+    //! @param[in]  activations   The activation function of each layer.
+    //! @param[out] out_outputs   The outputs. A row vector.
+    template <typename DerivedI, typename DerivedW0, typename DerivedW1, typename DerivedO>
+    void feedForward(Eigen::MatrixBase<DerivedI> const& inputs, Eigen::MatrixBase<DerivedW0> const& inputWeights, Eigen::MatrixBase<DerivedW1> const& outputWeights,
+                     Activations const activations, Eigen::MatrixBase<DerivedO>& out_outputs)
+    {
+        Eigen::Index constexpr blockSize = 16;
+        Eigen::Index const numHidden = inputWeights.cols();
+        assert(outputWeights.rows() == numHidden + 1);
+
+        float hidden[blockSize];
+        out_outputs = outputWeights.row(0);  // The bias.
+        for (Eigen::Index first = 0; first < numHidden; first += blockSize)
+        {
+            Eigen::Index const count = std::min(blockSize, numHidden - first);
+            Eigen::Map<Eigen::RowVectorXf> block(hidden, count);
+            block.noalias() = inputs * inputWeights.middleCols(first, count);
+            Activate(activations.hidden, hidden, static_cast<size_t>(count));
+            out_outputs.noalias() += block * outputWeights.middleRows(first + 1, count);
+        }
+        Activate(activations.output, out_outputs.derived().data(), static_cast<size_t>(out_outputs.size()));
+    }
+
+} } }
@@ -0,0 +1,286 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "ml/Activation.h"
+
+#include "ml/WeightOperations.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace fcb { namespace ml {
+
+
+namespace {
+
+    // Each instruction set is wrapped in the same small set of operations, so the kernels below are written once.
+    // Every instruction set the compiler targets is built (see the -march=native and /arch:AVX2 flags in the top CMakeLists.txt).
+    // Activate uses the widest. The others can be picked with ActivateWith, e.g. to check them against each other.
+
+#if defined(__AVX2__)
+    struct Avx2
+    {
+        using Packet = __m256;
+        using Int    = __m256i;
+        static size_t constexpr c_width = 8;
+
+        static Packet Load(float const* values)         { return _mm256_loadu_ps(values); }
+        static void   Store(float* values, Packet a)    { _mm256_storeu_ps(values, a); }
+        static Packet Set(float const value)            { return _mm256_set1_ps(value); }
+        static Packet Add(Packet a, Packet b)           { return _mm256_add_ps(a, b); }
+        static Packet Sub(Packet a, Packet b)           { return _mm256_sub_ps(a, b); }
+        static Packet Mul(Packet a, Packet b)           { return _mm256_mul_ps(a, b); }
+        static Packet Div(Packet a, Packet b)           { return _mm256_div_ps(a, b); }
+        static Packet Min(Packet a, Packet b)           { return _mm256_min_ps(a, b); }
+        static Packet Max(Packet a, Packet b)           { return _mm256_max_ps(a, b); }
+        static Packet Abs(Packet a)                     { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static Int    Round(Packet a)                   { return _mm256_cvtps_epi32(a); }  // To nearest, ties to even.
+        static Packet ToFloat(Int n)                    { return _mm256_cvtepi32_ps(n); }
+        static Packet Pow2(Int n)                       { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23)); }
+    };
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    struct Sse2
+    {
+        using Packet = __m128;
+        using Int    = __m128i;
+        static size_t constexpr c_width = 4;
+
+        static Packet Load(float const* values)         { return _mm_loadu_ps(values); }
+        static void   Store(float* values, Packet a)    { _mm_storeu_ps(values, a); }
+        static Packet Set(float const value)            { return _mm_set1_ps(value); }
+        static Packet Add(Packet a, Packet b)           { return _mm_add_ps(a, b); }
+        static Packet Sub(Packet a, Packet b)           { return _mm_sub_ps(a, b); }
+        static Packet Mul(Packet a, Packet b)           { return _mm_mul_ps(a, b); }
+        static Packet Div(Packet a, Packet b)           { return _mm_div_ps(a, b); }
+        static Packet Min(Packet a, Packet b)           { return _mm_min_ps(a, b); }
+        static Packet Max(Packet a, Packet b)           { return _mm_max_ps(a, b); }
+        static Packet Abs(Packet a)                     { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static Int    Round(Packet a)                   { return _mm_cvtps_epi32(a); }  // To nearest, ties to even.
+        static Packet ToFloat(Int n)                    { return _mm_cvtepi32_ps(n); }
+        static Packet Pow2(Int n)                       { return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23)); }
+    };
+#endif
+
+    struct Scalar
+    {
+        using Packet = float;
+        using Int    = int32_t;
+        static size_t constexpr c_width = 1;
+
+        static Packet Load(float const* values)         { return *values; }
+        static void   Store(float* values, Packet a)    { *values = a; }
+        static Packet Set(float const value)            { return value; }
+        static Packet Add(Packet a, Packet b)           { return a + b; }
+        static Packet Sub(Packet a, Packet b)           { return a - b; }
+        static Packet Mul(Packet a, Packet b)           { return a * b; }
+        static Packet Div(Packet a, Packet b)           { return a / b; }
+        static Packet Min(Packet a, Packet b)           { return std::min(a, b); }
+        static Packet Max(Packet a, Packet b)           { return std::max(a, b); }
+        static Packet Abs(Packet a)                     { return std::fabs(a); }
+        static Int    Round(Packet a)                   { return static_cast<Int>(std::lrint(a)); }  // To nearest, ties to even.
+        static Packet ToFloat(Int n)                    { return static_cast<float>(n); }
+        static Packet Pow2(Int n)
+        {
+            uint32_t const bits = static_cast<uint32_t>(n + 127) << 23;
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+    };
+
+    //! e^x, by splitting x into n ln(2) + r with |r| <= ln(2) / 2, so e^x = 2^n e^r,
+    //! and e^r is a degree 6 polynomial (the Cephes expf coefficients).
+    //! x is clamped to +-87 first, so the result is always finite and normal.
+    template <typename Simd>
+    typename Simd::Packet fastExp(typename Simd::Packet x)
+    {
+        using Packet = typename Simd::Packet;
+        x = Simd::Min(Simd::Max(x, Simd::Set(-87.0f)), Simd::Set(87.0f));
+        typename Simd::Int const n = Simd::Round(Simd::Mul(x, Simd::Set(1.44269504088896341f)));  // log2(e)
+        Packet const nf = Simd::ToFloat(n);
+        // ln(2) in two parts, so n times the first part is exact.
+        Packet const r = Simd::Sub(Simd::Sub(x, Simd::Mul(nf, Simd::Set(0.693359375f))), Simd::Mul(nf, Simd::Set(-2.12194440e-4f)));
+
+        Packet p = Simd::Set(1.9875691500e-4f);
+        p = Simd::Add(Simd::Mul(p, r), Simd::Set(1.3981999507e-3f));
+        p = Simd::Add(Simd::Mul(p, r), Simd::Set(8.3334519073e-3f));
+        p = Simd::Add(Simd::Mul(p, r), Simd::Set(4.1665795894e-2f));
+        p = Simd::Add(Simd::Mul(p, r), Simd::Set(1.6666665459e-1f));
+        p = Simd::Add(Simd::Mul(p, r), Simd::Set(5.0000001201e-1f));
+        p = Simd::Add(Simd::Add(Simd::Mul(Simd::Mul(p, r), r), r), Simd::Set(1.0f));
+        return Simd::Mul(p, Simd::Pow2(n));
+    }
+
+    template <typename Simd>
+    typename Simd::Packet fastSigmoid(typename Simd::Packet const z)
+    {
+        auto const one = Simd::Set(1.0f);
+        return Simd::Div(one, Simd::Add(one, fastExp<Simd>(Simd::Sub(Simd::Set(0.0f), z))));
+    }
+
+    template <typename Simd>
+    typename Simd::Packet roughSigmoid(typename Simd::Packet const z)
+    {
+        auto const half = Simd::Set(0.5f);
+        return Simd::Add(half, Simd::Mul(half, Simd::Div(z, Simd::Add(Simd::Set(1.0f), Simd::Abs(z)))));
+    }
+
+    //! 1 - 2 / (1 + e^2z). Goes to exactly +-1 as e^2z saturates.
+    template <typename Simd>
+    typename Simd::Packet fastTanh(typename Simd::Packet const z)
+    {
+        auto const one = Simd::Set(1.0f);
+        return Simd::Sub(one, Simd::Div(Simd::Set(2.0f), Simd::Add(one, fastExp<Simd>(Simd::Add(z, z)))));
+    }
+
+    template <typename Simd>
+    typename Simd::Packet relu(typename Simd::Packet const z)
+    {
+        return Simd::Max(z, Simd::Set(0.0f));
+    }
+
+    //! Apply a kernel to every value, a packet at a time.
+    //! The leftover values at the end go through the same kernel in a padded packet, never a scalar loop,
+    //! so a value's result doesn't depend on where it falls in the range. That keeps batched networks bit-identical
+    //! however a batch is split between threads.
+    template <typename Simd, typename Kernel>
+    void apply(Kernel const& kernel, float* values, size_t const count)
+    {
+        size_t i = 0;
+        for (; i + Simd::c_width <= count; i += Simd::c_width)
+            Simd::Store(values + i, kernel(Simd::Load(values + i)));
+        if (i < count)
+        {
+            float tail[Simd::c_width] = {};
+            std::copy(values + i, values + count, tail);
+            Simd::Store(tail, kernel(Simd::Load(tail)));
+            std::copy(tail, tail + (count - i), values + i);
+        }
+    }
+
+    //! Activate with one instruction set.
+    template <typename Simd>
+    void activate(Activation const activation, float* values, size_t const count)
+    {
+        switch (activation)
+        {
+        case Activation::Sigmoid:
+            std::transform(values, values + count, values, detail::sigmoid);
+            return;
+        case Activation::FastSigmoid:
+            apply<Simd>(fastSigmoid<Simd>, values, count);
+            return;
+        case Activation::RoughSigmoid:
+            apply<Simd>(roughSigmoid<Simd>, values, count);
+            return;
+        case Activation::Tanh:
+            apply<Simd>(fastTanh<Simd>, values, count);
+            return;
+        case Activation::Relu:
+            apply<Simd>(relu<Simd>, values, count);
+            return;
+        }
+        assert(false);
+    }
+
+    char const* const c_activationNames[c_numActivations] = { "sigmoid", "fast-sigmoid", "rough-sigmoid", "tanh", "relu" };
+
+}  // Anonymous namespace.
+
+
+//! Apply an activation function to values in place, with the widest instruction set the build targets.
+//! @param[in]     activation Which function.
+//! @param[in/out] values     The inputs, overwritten with the outputs.
+//! @param[in]     count      The number of values.
+void Activate(Activation const activation, float* values, size_t const count)
+{
+#if defined(__AVX2__)
+    activate<Avx2>(activation, values, count);
+#elif defined(__SSE2__) || defined(_M_X64)
+    activate<Sse2>(activation, values, count);
+#else
+    activate<Scalar>(activation, values, count);
+#endif
+}
+
+//! Same as Activate, but with a given instruction set instead of the widest.
+//! @param[in] instructionSet Which instruction set.
+//! @return false if the build doesn't target the instruction set. The values are unchanged.
+bool ActivateWith(InstructionSet const instructionSet, Activation const activation, float* values, size_t const count)
+{
+    switch (instructionSet)
+    {
+    case InstructionSet::Scalar:
+        activate<Scalar>(activation, values, count);
+        return true;
+    case InstructionSet::Sse2:
+#if defined(__SSE2__) || defined(_M_X64)
+        activate<Sse2>(activation, values, count);
+        return true;
+#else
+        return false;
+#endif
+    case InstructionSet::Avx2:
+#if defined(__AVX2__)
+        activate<Avx2>(activation, values, count);
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+//! @return The name of an activation function, as accepted by ParseActivation.
+char const* ActivationName(Activation const activation)
+{
+    auto const index = static_cast<size_t>(activation);
+    assert(index < c_numActivations);
+    return c_activationNames[index];
+}
+
+//! Look up an activation function by name.
+//! @param[in]  name           e.g. "fast-sigmoid". See ActivationName.
+//! @param[out] out_activation The function. Unchanged if the name isn't known.
+//! @return false if the name isn't known.
+bool ParseActivation(char const* name, Activation& out_activation)
+{
+    for (size_t i = 0; i < c_numActivations; ++i)
+    {
+        if (std::strcmp(name, c_activationNames[i]) == 0)
+        {
+            out_activation = static_cast<Activation>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+} }
@@ -0,0 +1,75 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "ml/AliasTable.h"
+
+#include <cassert>
+#include <numeric>
+
+namespace fcb { namespace ml {
+
+
+//! Constructor. Builds the table.
+//! @param[in] weights The relative chance of each index. Must not be empty. Must be non-negative, with a positive sum.
+AliasTable::AliasTable(std::vector<double> const& weights)
+    : m_probability(weights.size(), 1)
+    , m_alias(weights.size())
+{
+    assert(!weights.empty());
+    double const sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    assert(sum > 0);
+
+    // Scale the weights so the average is 1. Each column of the table holds a total of 1:
+    // some of its own index, topped up with some of one index that has more than 1 to give.
+    std::vector<double> scaled(weights.size());
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        scaled[i] = weights[i] * static_cast<double>(weights.size()) / sum;
+        m_alias[i] = i;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        size_t const less = small.back();
+        small.pop_back();
+        size_t const more = large.back();
+
+        m_probability[less] = scaled[less];
+        m_alias[less] = more;
+
+        scaled[more] = (scaled[more] + scaled[less]) - 1;
+        if (scaled[more] < 1)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Whatever is left is 1, give or take rounding error, so it keeps its whole column (the default).
+}
+
+//! @return The number of indexes.
+size_t AliasTable::Size() const
+{
+    return m_probability.size();
+}
+
+
+} }
@@ -20,6 +20,8 @@
 
 #include "util/Util.h"
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace fcb { namespace ml {
@@ -47,57 +49,129 @@ namespace {
         return index;
     }
 
-}  // Anonymous namespace.
+    //! Bit-wise breed two floats.
+    //! @param[in] f_m Parent float one.
+    //! @param[in] f_f Parent float two.
+    //! @param[in] rng The random number generator to draw from.
+    //! @return A mix of the common bits plus a chance to flip bits.
+    template <typename URBG>
+    float breedFloat_impl(float const f_m, float const f_f, URBG& rng)
+    {
+        float constexpr mutationRate = .05f;
 
+        static_assert(sizeof(float) == sizeof(uint32_t), "Floating points on this architecture are not 32-bit.");
 
-//! Bit-wise breed two floats.
-//! @param[in] f_m Parent float one.
-//! @param[in] f_f Parent float two.
-//! @return A mix of the common bits plus a chance to flip bits.
-float breedFloat(float const f_m, float const f_f)
-{
-    float constexpr mutationRate = .05f;
+        std::uniform_real_distribution<> distReal(0, 1);
+        std::uniform_int_distribution<> distInt(0, 31);
+
+        // Convert to uint.
+        uint32_t u_m, u_f;
+        std::memcpy(&u_m, &f_m, sizeof(uint32_t));
+        std::memcpy(&u_f, &f_f, sizeof(uint32_t));
 
-    static_assert(sizeof(float) == sizeof(uint32_t), "Floating points on this architecture are not 32-bit.");
+        // Create a mask.
+        // The 0's mean no change. The 1's should be randomly selected.
+        auto const mask = u_m ^ u_f;
+        // Create a random mask.
+        auto const rand = static_cast<uint32_t>(rng());
+        // Create a flipping mask. 1=flip. 0=no flip.
+        auto flipper = mask & rand;
 
-    std::uniform_real_distribution<> distReal(0, 1);
-    std::uniform_int_distribution<> distInt(0, 31);
+        for (int i = 0; i < 32; ++i)
+        {
+            if (distReal(rng) < mutationRate)
+                flipper ^= 1 << distInt(rng);
+        }
 
-    // Convert to uint.
-    uint32_t u_m, u_f;
-    std::memcpy(&u_m, &f_m, sizeof(uint32_t));
-    std::memcpy(&u_f, &f_f, sizeof(uint32_t));
+        //0101 m
+        //0011 f
+        //0110 ^
+        //???? r
+        //0??0 flip = (^) & (mask)
+        //0??1 flip ^ m
 
-    // Create a mask.
-    // The 0's mean no change. The 1's should be randomly selected.
-    auto const mask = u_m ^ u_f;
-    // Create a random mask.
-    auto const rand = static_cast<uint32_t>(util::rng()());
-    // Create a flipping mask. 1=flip. 0=no flip.
-    auto flipper = mask & rand;
+        // Could have picked m or f.
+        uint32_t const u_c = u_f ^ flipper;
 
-    for (int i = 0; i < 32; ++i)
+        // Convert result to float.
+        float f_c;
+        std::memcpy(&f_c, &u_c, sizeof(float));
+        return f_c;
+    }
+
+}  // Anonymous namespace.
+
+
+//! Turn a selection policy into the chance of picking each rank.
+//! @param[in] policy         The selection policy. Out of range parameters are clamped.
+//! @param[in] populationSize The number of ranks.
+//! @return The chance of picking each rank, best first. Sums to 1.
+std::vector<double> RankWeights(SelectionPolicy const& policy, size_t const populationSize)
+{
+    std::vector<double> weights(populationSize, 1);
+    auto const n = static_cast<double>(populationSize);
+
+    switch (policy.kind)
+    {
+    case SelectionPolicy::Kind::LinearRank:
     {
-        if (distReal(util::rng()) < mutationRate)
-            flipper ^= 1 << distInt(util::rng());
+        // Baker's linear ranking: from s for the best down to 2 - s for the worst.
+        double const pressure = std::clamp(policy.parameter, 1.0, 2.0);
+        for (size_t rank = 0; rank < populationSize && populationSize > 1; ++rank)
+            weights[rank] = pressure - (2 * pressure - 2) * static_cast<double>(rank) / (n - 1);
+        break;
+    }
+    case SelectionPolicy::Kind::ExponentialRank:
+    {
+        double const base = std::clamp(policy.parameter, 1e-6, 1.0);
+        double weight = 1;
+        for (auto& w : weights)
+        {
+            w = weight;
+            weight = std::max(weight * base, 1e-300);  // Don't underflow to 0 in big populations.
+        }
+        break;
+    }
+    case SelectionPolicy::Kind::Tournament:
+    {
+        // The best of k uniform picks (with replacement) has rank >= r with chance ((n - r) / n)^k,
+        // so a tournament is the same as drawing from these weights, without rolling k times.
+        double const size = std::max(policy.parameter, 1.0);
+        for (size_t rank = 0; rank < populationSize; ++rank)
+        {
+            auto const r = static_cast<double>(rank);
+            weights[rank] = std::pow((n - r) / n, size) - std::pow((n - r - 1) / n, size);
+        }
+        break;
+    }
     }
 
-    //0101 m
-    //0011 f
-    //0110 ^
-    //???? r
-    //0??0 flip = (^) & (mask)
-    //0??1 flip ^ m
+    double const sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    for (auto& w : weights)
+        w /= sum;
+    return weights;
+}
 
-    // Could have picked m or f.
-    uint32_t const u_c = u_f ^ flipper;
+//! Bit-wise breed two floats, drawing from the global random number generator.
+//! @param[in] f_m Parent float one.
+//! @param[in] f_f Parent float two.
+//! @return A mix of the common bits plus a chance to flip bits.
+float breedFloat(float const f_m, float const f_f)
+{
+    return breedFloat_impl(f_m, f_f, util::rng());
+}
 
-    // Convert result to float.
-    float f_c;
-    std::memcpy(&f_c, &u_c, sizeof(float));
-    return f_c;
+//! Bit-wise breed two floats.
+//! @param[in] f_m Parent float one.
+//! @param[in] f_f Parent float two.
+//! @param[in] rng The random number generator to draw from.
+//! @return A mix of the common bits plus a chance to flip bits.
+float breedFloat(float const f_m, float const f_f, util::Philox4x32& rng)
+{
+    return breedFloat_impl(f_m, f_f, rng);
 }
 
+
 //! Select a parent by returning a random rank index.
 //! Lower indexes (i.e. higher rank) has a higher chance of being selected.
 //! The chance is hard-coded in this function (bad design, but works for now).
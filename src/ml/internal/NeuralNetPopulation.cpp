@@ -0,0 +1,299 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#include "ml/NeuralNetPopulation.h"
+
+#include "ml/WeightOperations.h"
+#include "util/BinaryIO.h"
+#include "util/Util.h"
+
+#include <cassert>
+
+namespace fcb { namespace ml {
+
+
+using detail::crossoverMatrix;
+using detail::feedForward;
+using detail::mutateMatrix;
+
+namespace {
+
+    Eigen::Index constexpr c_numInputRows = static_cast<Eigen::Index>(NeuralNet::NUM_INPUTS) + 1;  // +1 for bias.
+
+}  // Anonymous namespace.
+
+
+//! Constructor.
+//! All the weights start at 0. Fill them in with Randomize or Crossover.
+//! @param[in] size      The number of networks.
+//! @param[in] numHidden The number of nodes in each network's hidden layer.
+NeuralNetPopulation::NeuralNetPopulation(size_t const size, unsigned const numHidden)
+    : m_numHidden(numHidden)
+{
+    Eigen::Index const genomeSize = c_numInputRows * numHidden + (static_cast<Eigen::Index>(numHidden) + 1) * NeuralNet::NUM_OUTPUTS;
+    m_genomes = Eigen::MatrixXf::Zero(genomeSize, static_cast<Eigen::Index>(size));
+    m_nextGenomes = Eigen::MatrixXf::Zero(genomeSize, static_cast<Eigen::Index>(size));
+}
+
+//! @return A copy of all of one network's weights.
+//! @param[in] index Which network.
+Eigen::VectorXf NeuralNetPopulation::Genome(size_t const index) const
+{
+    return m_genomes.col(static_cast<Eigen::Index>(index));
+}
+
+//! Overwrite all of one network's weights.
+//! @param[in] index  Which network.
+//! @param[in] genome The weights, as returned by Genome. Must be GenomeSize() long.
+void NeuralNetPopulation::SetGenome(size_t const index, Eigen::VectorXf const& genome)
+{
+    assert(genome.size() == GenomeSize());
+    m_genomes.col(static_cast<Eigen::Index>(index)) = genome;
+}
+
+//! Initialize one network's weights randomly, the same way NeuralNet does.
+//! @param[in] index Which network.
+//! @param[in] rng   The random number generator to draw from.
+void NeuralNetPopulation::Randomize(size_t const index, util::Philox4x32& rng)
+{
+    std::uniform_real_distribution<float> distribution(-0.8f, 0.8f);
+    m_genomes.col(static_cast<Eigen::Index>(index)) = Eigen::VectorXf::NullaryExpr(GenomeSize(), [&distribution, &rng]() { return distribution(rng); });
+}
+
+//! @return The number of networks in the population.
+size_t NeuralNetPopulation::Size() const
+{
+    return static_cast<size_t>(m_genomes.cols());
+}
+
+//! @return The number of weights in one network.
+Eigen::Index NeuralNetPopulation::GenomeSize() const
+{
+    return m_genomes.rows();
+}
+
+//! @return The number of nodes in each network's hidden layer.
+unsigned NeuralNetPopulation::NumHidden() const
+{
+    return m_numHidden;
+}
+
+//! @return Scratch space to pass to the ranged FeedForward: one row of hidden layer activations per network, plus a bias column.
+//! Keep it with the batch and reuse it, so feeding forward never allocates.
+NeuralNetPopulation::HiddenBatchType NeuralNetPopulation::HiddenBatch() const
+{
+    return HiddenBatchType::Zero(static_cast<Eigen::Index>(Size()), m_numHidden + 1);
+}
+
+//! @return The activation function of each layer. Every network in the population uses the same ones.
+Activations NeuralNetPopulation::GetActivations() const
+{
+    return m_activations;
+}
+
+//! Change the activation function of each layer, for every network. Doesn't touch the weights.
+//! @param[in] activations The functions.
+void NeuralNetPopulation::SetActivations(Activations const activations)
+{
+    m_activations = activations;
+}
+
+//! Feed the input forward through one network and return the outputs. Doesn't allocate.
+//! @param[in]  index       Which network to use.
+//! @param[in]  inputs      A vector of input values.
+//! @param[out] out_outputs A vector to hold output results.
+void NeuralNetPopulation::FeedForward(size_t const index, InputType const& inputs, OutputType& out_outputs) const
+{
+    // The bias must be set to 1.
+    assert(inputs.m_input(0) == 1);
+    feedForward(inputs.m_input, inputWeights(index), outputWeights(index), m_activations, out_outputs);
+}
+
+//! Feed a batch of inputs forward through every network at once.
+//! Each network has its own weights, so a layer is a block-diagonal product: one small product per network, written into one matrix.
+//! Every activation function gives the same result for a value wherever it falls in the range (see Activate),
+//! so a network's outputs are bit-identical no matter which range it was fed in.
+//! Allocates scratch space for the hidden layer. To feed forward over and over, keep a HiddenBatch and use the ranged overload.
+//! @param[in]  inputs      One row of inputs per network. Must have Size() rows.
+//! @param[out] out_outputs Will be resized to hold one row of outputs per network.
+void NeuralNetPopulation::FeedForward(InputBatchType const& inputs, OutputBatchType& out_outputs) const
+{
+    out_outputs.resize(static_cast<Eigen::Index>(Size()), Eigen::NoChange);
+    HiddenBatchType scratch = HiddenBatch();
+    FeedForward(inputs, out_outputs, scratch, 0, Size());
+}
+
+//! Feed the rows [begin, end) of a batch forward through their networks. Doesn't allocate.
+//! Only touches those rows, so disjoint ranges can run on different threads.
+//! @param[in]  inputs      One row of inputs per network. Must have Size() rows.
+//! @param[out] out_outputs One row of outputs per network. Must already have Size() rows.
+//! @param[out] scratch     Space for the hidden layer, from HiddenBatch. Only rows [begin, end) are touched.
+//! @param[in]  begin       The first network.
+//! @param[in]  end         One past the last network.
+void NeuralNetPopulation::FeedForward(InputBatchType const& inputs, OutputBatchType& out_outputs, HiddenBatchType& scratch, size_t const begin, size_t const end) const
+{
+    assert(inputs.m_input.rows() == static_cast<Eigen::Index>(Size()));
+    assert(out_outputs.rows() == static_cast<Eigen::Index>(Size()));
+    assert(scratch.rows() == static_cast<Eigen::Index>(Size()) && scratch.cols() == m_numHidden + 1);
+    assert(begin <= end && end <= Size());
+    auto const first = static_cast<Eigen::Index>(begin);
+    auto const count = static_cast<Eigen::Index>(end - begin);
+    // The bias must be set to 1.
+    assert((inputs.m_input.col(0).segment(first, count).array() == 1).all());
+
+    // Activate input->hidden layer. The bias is the first column.
+    auto hiddenActivation = scratch.middleRows(first, count);
+    for (Eigen::Index i = 0; i < count; ++i)
+        hiddenActivation.row(i).tail(m_numHidden) = inputs.m_input.row(first + i).lazyProduct(inputWeights(static_cast<size_t>(first + i)));
+    // The rows are contiguous, so activate the whole block in one sweep, bias column and all, then put the bias back.
+    Activate(m_activations.hidden, hiddenActivation.data(), static_cast<size_t>(hiddenActivation.size()));
+    hiddenActivation.col(0).setOnes();
+
+    // Activate hidden->output layer.
+    auto outputs = out_outputs.middleRows(first, count);
+    for (Eigen::Index i = 0; i < count; ++i)
+        outputs.row(i) = hiddenActivation.row(i).lazyProduct(outputWeights(static_cast<size_t>(first + i)));
+    Activate(m_activations.output, outputs.data(), static_cast<size_t>(outputs.size()));
+}
+
+//! Write every network's weights to a binary stream.
+//! A small header describes the topology and activations. The weights follow as one aligned block of floats,
+//! in the same layout as in memory, so loading is a single read and a mapped file can be viewed in place.
+//! @param[in] out The stream. Should be opened in binary mode.
+void NeuralNetPopulation::Save(std::ostream& out) const
+{
+    util::WriteRaw(out, uint32_t(NeuralNet::NUM_INPUTS));
+    util::WriteRaw(out, uint32_t(m_numHidden));
+    util::WriteRaw(out, uint32_t(NeuralNet::NUM_OUTPUTS));
+    util::WriteRaw(out, uint32_t(m_activations.hidden) | uint32_t(m_activations.output) << 8);  // Was reserved (0), so older files load as sigmoid.
+    util::WriteRaw(out, uint64_t(Size()));
+    util::WriteRaw(out, uint64_t(GenomeSize()));
+    util::WritePadding(out);
+    util::WriteRaw(out, m_genomes.data(), static_cast<size_t>(m_genomes.size()));
+}
+
+//! Replace the whole population with one written by Save. The population takes the size, topology, and activations from the stream.
+//! @param[in] in The stream. Should be opened in binary mode.
+//! @return false if the stream is truncated or holds networks with different inputs or outputs. The population is unchanged on failure.
+bool NeuralNetPopulation::Load(std::istream& in)
+{
+    uint32_t numInputs = 0, numHidden = 0, numOutputs = 0, activations = 0;
+    uint64_t size = 0, genomeSize = 0;
+    if (!util::ReadRaw(in, numInputs) || !util::ReadRaw(in, numHidden) || !util::ReadRaw(in, numOutputs) || !util::ReadRaw(in, activations)
+        || !util::ReadRaw(in, size) || !util::ReadRaw(in, genomeSize) || !util::SkipPadding(in))
+        return false;
+    uint64_t const expectedGenomeSize = uint64_t(numInputs + 1) * numHidden + (uint64_t(numHidden) + 1) * numOutputs;
+    if (numInputs != NeuralNet::NUM_INPUTS || numOutputs != NeuralNet::NUM_OUTPUTS || genomeSize != expectedGenomeSize)
+        return false;
+    uint32_t const hidden = activations & 0xff;
+    uint32_t const output = activations >> 8;
+    if (hidden >= c_numActivations || output >= c_numActivations)
+        return false;
+
+    if (size > util::BytesLeft(in) / (genomeSize * sizeof(float)))
+        return false;
+
+    // Read straight into the final storage.
+    Eigen::MatrixXf genomes(static_cast<Eigen::Index>(genomeSize), static_cast<Eigen::Index>(size));
+    if (!util::ReadRaw(in, genomes.data(), static_cast<size_t>(genomes.size())))
+        return false;
+
+    m_numHidden = numHidden;
+    m_activations = { static_cast<Activation>(hidden), static_cast<Activation>(output) };
+    m_genomes.swap(genomes);
+    m_nextGenomes.setZero(m_genomes.rows(), m_genomes.cols());
+    return true;
+}
+
+//! Breed one network of the next generation from two of the current one. Writes to the second arena, so the current
+//! generation is untouched and every network can still be picked as a parent. Call NextGeneration once they are all bred.
+//! Different children can be bred on different threads.
+//! @param[in] m   Index of parent one in the current generation.
+//! @param[in] f   Index of parent two. Can be the same.
+//! @param[in] c   Index of the child in the next generation.
+//! @param[in] rng The random number generator to draw from.
+void NeuralNetPopulation::BreedChild(size_t const m, size_t const f, size_t const c, util::Philox4x32& rng)
+{
+    breed(*this, m, f, childInputWeights(c), childOutputWeights(c), rng);
+}
+
+//! Make the bred children the current generation. Swaps the arenas' pointers: no weights are copied.
+//! The old generation's arena is reused for the next round of breeding.
+void NeuralNetPopulation::NextGeneration()
+{
+    m_genomes.swap(m_nextGenomes);
+}
+
+//! Combine the weights from two networks to make a new one.
+//! @param[in]  parents      The population holding the parents.
+//! @param[in]  m            Index of parent one.
+//! @param[in]  f            Index of parent two. Can be the same.
+//! @param[out] out_children The population to write the child into. Must be a different population than parents.
+//! @param[in]  c            Index of the child.
+//! @param[in]  rng          The random number generator to draw from.
+void NeuralNetPopulation::Crossover(NeuralNetPopulation const& parents, size_t const m, size_t const f, NeuralNetPopulation& out_children, size_t const c, util::Philox4x32& rng)
+{
+    assert(&parents != &out_children && parents.m_numHidden == out_children.m_numHidden);
+    breed(parents, m, f, out_children.inputWeights(c), out_children.outputWeights(c), rng);
+}
+
+//! Cross over two parents' weights into a child's, slice by slice, then maybe mutate them.
+void NeuralNetPopulation::breed(NeuralNetPopulation const& parents, size_t const m, size_t const f, WeightsMap childInput, WeightsMap childOutput, util::Philox4x32& rng)
+{
+    crossoverMatrix(parents.inputWeights(m),  parents.inputWeights(f),  childInput,  rng);
+    crossoverMatrix(parents.outputWeights(m), parents.outputWeights(f), childOutput, rng);
+    mutateMatrix(childInput,  rng);
+    mutateMatrix(childOutput, rng);
+}
+
+//! @return A view of one network's input->hidden weights.
+NeuralNetPopulation::ConstWeightsMap NeuralNetPopulation::inputWeights(size_t const index) const
+{
+    return ConstWeightsMap(m_genomes.col(static_cast<Eigen::Index>(index)).data(), c_numInputRows, m_numHidden);
+}
+
+//! @return A view of one network's hidden->output weights.
+NeuralNetPopulation::ConstWeightsMap NeuralNetPopulation::outputWeights(size_t const index) const
+{
+    return ConstWeightsMap(m_genomes.col(static_cast<Eigen::Index>(index)).data() + c_numInputRows * m_numHidden, m_numHidden + 1, NeuralNet::NUM_OUTPUTS);
+}
+
+NeuralNetPopulation::WeightsMap NeuralNetPopulation::inputWeights(size_t const index)
+{
+    return WeightsMap(m_genomes.col(static_cast<Eigen::Index>(index)).data(), c_numInputRows, m_numHidden);
+}
+
+NeuralNetPopulation::WeightsMap NeuralNetPopulation::outputWeights(size_t const index)
+{
+    return WeightsMap(m_genomes.col(static_cast<Eigen::Index>(index)).data() + c_numInputRows * m_numHidden, m_numHidden + 1, NeuralNet::NUM_OUTPUTS);
+}
+
+//! @return A view of where BreedChild writes one child's input->hidden weights.
+NeuralNetPopulation::WeightsMap NeuralNetPopulation::childInputWeights(size_t const index)
+{
+    return WeightsMap(m_nextGenomes.col(static_cast<Eigen::Index>(index)).data(), c_numInputRows, m_numHidden);
+}
+
+//! @return A view of where BreedChild writes one child's hidden->output weights.
+NeuralNetPopulation::WeightsMap NeuralNetPopulation::childOutputWeights(size_t const index)
+{
+    return WeightsMap(m_nextGenomes.col(static_cast<Eigen::Index>(index)).data() + c_numInputRows * m_numHidden, m_numHidden + 1, NeuralNet::NUM_OUTPUTS);
+}
+
+
+} }
@@ -0,0 +1,115 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+// Helpers for binary files that are read back by memcpy or memory mapping:
+// values are written as their raw bytes in native byte order, and arrays start on aligned offsets.
+
+namespace fcb { namespace util {
+
+
+//! Arrays in binary files start at a multiple of this many bytes, so a mapped file can be used in place by SIMD code.
+size_t constexpr c_binaryAlignment = 64;
+
+//! Write values as raw bytes.
+//! @param[in] out   The stream. Should be opened in binary mode.
+//! @param[in] data  The values.
+//! @param[in] count The number of values.
+template <typename T>
+void WriteRaw(std::ostream& out, T const* data, size_t const count)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written as raw bytes.");
+    out.write(reinterpret_cast<char const*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+//! Write a value as raw bytes.
+template <typename T>
+void WriteRaw(std::ostream& out, T const& value)
+{
+    WriteRaw(out, &value, 1);
+}
+
+//! Read values written by WriteRaw.
+//! @param[in]  in       The stream. Should be opened in binary mode.
+//! @param[out] out_data Where to put the values.
+//! @param[in]  count    The number of values.
+//! @return false if the stream ran out.
+template <typename T>
+bool ReadRaw(std::istream& in, T* out_data, size_t const count)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read as raw bytes.");
+    in.read(reinterpret_cast<char*>(out_data), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+//! Read a value written by WriteRaw.
+template <typename T>
+bool ReadRaw(std::istream& in, T& out_value)
+{
+    return ReadRaw(in, &out_value, 1);
+}
+
+//! Check counts read from a file against this before allocating for them, so a corrupt count fails the load instead of the allocation.
+//! @param[in] in The stream. Should be opened in binary mode.
+//! @return The number of bytes between the read position and the end of the stream. 0 if the stream can't tell.
+inline uint64_t BytesLeft(std::istream& in)
+{
+    auto const position = in.tellg();
+    if (position < 0)
+        return 0;
+    in.seekg(0, std::ios_base::end);
+    auto const end = in.tellg();
+    in.seekg(position);
+    return (end < position) ? 0 : static_cast<uint64_t>(end - position);
+}
+
+//! @return true if the stream has enough bytes left for count values. See BytesLeft.
+template <typename T>
+bool CanRead(std::istream& in, uint64_t const count)
+{
+    return count <= BytesLeft(in) / sizeof(T);
+}
+
+//! Write zeros until the stream position is a multiple of c_binaryAlignment.
+inline void WritePadding(std::ostream& out)
+{
+    auto const position = static_cast<size_t>(out.tellp());
+    for (size_t i = position % c_binaryAlignment; i != 0 && i < c_binaryAlignment; ++i)
+        out.put(0);
+}
+
+//! Skip the padding written by WritePadding.
+//! @return false if the stream ran out.
+inline bool SkipPadding(std::istream& in)
+{
+    auto const position = static_cast<size_t>(in.tellg());
+    size_t const remainder = position % c_binaryAlignment;
+    if (remainder != 0)
+        in.seekg(static_cast<std::streamoff>(c_binaryAlignment - remainder), std::ios_base::cur);
+    return static_cast<bool>(in);
+}
+
+
+} }
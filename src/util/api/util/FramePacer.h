@@ -0,0 +1,143 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+
+namespace fcb { namespace util {
+
+//! Paces a loop to a target rate without pinning a core.
+//! Sleeps until shortly before each deadline, then yields for the rest (the spin tail), because a sleep can overshoot
+//! by a scheduler tick. Deadlines are whole periods apart, so lateness in one frame doesn't push back the next.
+//! If the loop falls more than a period behind, the pacer starts over from now instead of racing to catch up.
+//! Keeps statistics on how late each wake-up is (the jitter), for checking that the pacing holds up.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //! Timing of the frames since the last ResetStatistics.
+    struct Statistics
+    {
+        size_t numFrames = 0;
+        double meanLateness = 0;    // How long after its deadline Wait returns, on average. Milliseconds.
+        double maxLateness = 0;     // Milliseconds.
+        double meanFrameTime = 0;   // Milliseconds between returns from Wait.
+        double frameTimeStdDev = 0; // Milliseconds.
+    };
+
+    //! Constructor.
+    //! @param[in] targetRate Frames per second. 0 doesn't wait at all.
+    //! @param[in] spinTail   How long before each deadline to stop sleeping. Should cover the OS's sleep granularity.
+    explicit FramePacer(double const targetRate = 60, Clock::duration const spinTail = std::chrono::milliseconds(2))
+        : m_spinTail(spinTail)
+    {
+        SetTargetRate(targetRate);
+    }
+
+    //! @param[in] targetRate Frames per second. 0 doesn't wait at all. Takes effect from the next frame.
+    void SetTargetRate(double const targetRate)
+    {
+        m_targetRate = std::max(targetRate, 0.0);
+        m_period = (m_targetRate > 0)
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / m_targetRate))
+            : Clock::duration::zero();
+        m_deadline = Clock::now() + m_period;
+    }
+
+    //! @return Frames per second. 0 if not pacing.
+    double TargetRate() const
+    {
+        return m_targetRate;
+    }
+
+    //! Wait until it is time for the next frame.
+    void Wait()
+    {
+        if (m_targetRate > 0)
+        {
+            if (Clock::now() < m_deadline - m_spinTail)
+                std::this_thread::sleep_until(m_deadline - m_spinTail);
+            while (Clock::now() < m_deadline)
+                std::this_thread::yield();
+        }
+
+        Clock::time_point const now = Clock::now();
+        record(now);
+
+        // Next deadline. Resynchronize if more than a whole period behind.
+        m_deadline += m_period;
+        if (m_deadline < now)
+            m_deadline = now + m_period;
+    }
+
+    //! @return Timing of the frames since the last ResetStatistics.
+    Statistics GetStatistics() const
+    {
+        Statistics statistics = m_statistics;
+        size_t const numFrameTimes = m_statistics.numFrames > 0 ? m_statistics.numFrames - 1 : 0;
+        statistics.frameTimeStdDev = numFrameTimes > 1 ? std::sqrt(m_frameTimeM2 / static_cast<double>(numFrameTimes - 1)) : 0;
+        return statistics;
+    }
+
+    //! Start collecting statistics afresh.
+    void ResetStatistics()
+    {
+        m_statistics = Statistics();
+        m_frameTimeM2 = 0;
+    }
+
+private:
+    //! Add a frame to the statistics. Uses Welford's algorithm for the frame time's mean and variance.
+    void record(Clock::time_point const now)
+    {
+        auto const milliseconds = [](Clock::duration const duration) {
+            return std::chrono::duration<double, std::milli>(duration).count(); };
+
+        double const lateness = (m_targetRate > 0) ? std::max(milliseconds(now - m_deadline), 0.0) : 0;
+        ++m_statistics.numFrames;
+        m_statistics.meanLateness += (lateness - m_statistics.meanLateness) / static_cast<double>(m_statistics.numFrames);
+        m_statistics.maxLateness = std::max(m_statistics.maxLateness, lateness);
+
+        if (m_statistics.numFrames > 1)
+        {
+            double const frameTime = milliseconds(now - m_lastFrame);
+            auto const numFrameTimes = static_cast<double>(m_statistics.numFrames - 1);
+            double const delta = frameTime - m_statistics.meanFrameTime;
+            m_statistics.meanFrameTime += delta / numFrameTimes;
+            m_frameTimeM2 += delta * (frameTime - m_statistics.meanFrameTime);
+        }
+        m_lastFrame = now;
+    }
+
+    double m_targetRate = 0;
+    Clock::duration m_period {};
+    Clock::duration m_spinTail;
+    Clock::time_point m_deadline;
+    Clock::time_point m_lastFrame;
+
+    Statistics m_statistics;
+    double m_frameTimeM2 = 0;  // Sum of squared differences from the mean frame time.
+};
+
+} }
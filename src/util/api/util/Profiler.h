@@ -0,0 +1,334 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace fcb { namespace util {
+
+//! Collects how long named phases of work take, on any thread, for per-generation reports and trace files.
+//! Time the phases with ScopedTimer, and count things with Count.
+//! Each thread records into its own ring of events, allocated once, without locking. Taking a report drains the rings.
+//! A thread that records more events than its ring holds between two reports drops the extras, and the report counts them.
+//! Disabled by default. While disabled, a ScopedTimer costs one relaxed atomic load.
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //! The number of events each thread can record between two reports.
+    static size_t constexpr c_eventsPerThread = size_t(1) << 17;
+    //! The number of different counters each thread can use. More are ignored.
+    static size_t constexpr c_countersPerThread = 16;
+
+    //! The total time spent in one phase, summed over every thread, so it can exceed the wall time.
+    struct PhaseTotal
+    {
+        std::string name;
+        double milliseconds;
+        size_t count;
+    };
+
+    //! The total of one counter.
+    struct CounterTotal
+    {
+        std::string name;
+        int64_t value;
+    };
+
+    struct Report
+    {
+        std::vector<PhaseTotal> phases;      // In the order they were first seen.
+        std::vector<CounterTotal> counters;  // In the order they were first seen.
+    };
+
+    //! @return The singleton instance.
+    static Profiler& Get()
+    {
+        static Profiler s_profiler;
+        return s_profiler;
+    }
+
+    Profiler(Profiler const&)            = delete;
+    Profiler(Profiler&&)                 = delete;
+    Profiler& operator=(Profiler const&) = delete;
+    Profiler& operator=(Profiler&&)      = delete;
+
+    //! Start recording. Clears anything recorded before. Call it before the threads being timed start.
+    //! @param[in] trace Optional. Every report also writes its phases here, in the Chrome trace-event format, so memory doesn't grow however long the run.
+    //!                  Must stay open until Disable, which ends the trace.
+    //!                  Open the file in chrome://tracing or https://ui.perfetto.dev to see the phases of every thread on a timeline.
+    void Enable(std::ostream* trace = nullptr)
+    {
+        std::lock_guard<std::mutex> const lock(m_mutex);
+        endTrace();
+        for (auto const& log : m_logs)
+        {
+            log->numRead.store(log->numWritten.load(std::memory_order_acquire), std::memory_order_release);
+            log->numDropped.store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i < log->numCounters.load(std::memory_order_acquire); ++i)
+                log->counters[i].numReported = log->counters[i].value.load(std::memory_order_relaxed);
+        }
+        m_epoch = Clock::now();
+        m_trace = trace;
+        m_traceSeparator = "\n";
+        if (m_trace)
+            *m_trace << "{\"traceEvents\":[";
+        m_enabled.store(true, std::memory_order_relaxed);
+    }
+
+    //! Stop recording. If there is a trace, writes what hasn't been reported yet and ends it.
+    void Disable()
+    {
+        m_enabled.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> const lock(m_mutex);
+        collect();
+        endTrace();
+    }
+
+    bool IsEnabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    //! Record one run of a phase. ScopedTimer calls this. Doesn't lock or allocate, except for the first record on a thread.
+    //! @param[in] name  The phase. Must be a string literal, or otherwise outlive the profiler.
+    //! @param[in] start When the phase started.
+    //! @param[in] end   When the phase ended.
+    void Record(char const* const name, Clock::time_point const start, Clock::time_point const end)
+    {
+        if (!IsEnabled())
+            return;
+        ThreadLog& log = threadLog();
+        size_t const numWritten = log.numWritten.load(std::memory_order_relaxed);
+        if (numWritten - log.numRead.load(std::memory_order_acquire) == c_eventsPerThread)
+        {
+            log.numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        log.events[numWritten % c_eventsPerThread] = { name, start, end };
+        log.numWritten.store(numWritten + 1, std::memory_order_release);
+    }
+
+    //! Add to a counter. Doesn't lock or allocate, except for the first record on a thread.
+    //! @param[in] name   The counter. Must be a string literal, or otherwise outlive the profiler.
+    //! @param[in] amount How much to add.
+    void Count(char const* const name, int64_t const amount = 1)
+    {
+        if (!IsEnabled())
+            return;
+        ThreadLog& log = threadLog();
+        size_t const numCounters = log.numCounters.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < numCounters; ++i)
+        {
+            Counter& counter = log.counters[i];
+            if (counter.name == name)
+            {
+                // Only this thread writes the value, so a load and a store are enough.
+                counter.value.store(counter.value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+                return;
+            }
+        }
+        if (numCounters == c_countersPerThread)
+            return;
+        log.counters[numCounters].name = name;
+        log.counters[numCounters].value.store(amount, std::memory_order_relaxed);
+        log.numCounters.store(numCounters + 1, std::memory_order_release);
+    }
+
+    //! @return The totals since the last call, e.g. for one generation. Phases still running count toward the next report.
+    Report TakeReport()
+    {
+        std::lock_guard<std::mutex> const lock(m_mutex);
+        return collect();
+    }
+
+private:
+    struct Event
+    {
+        char const* name;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    struct Counter
+    {
+        char const* name = nullptr;  // Written before the counter is published through ThreadLog::numCounters.
+        std::atomic<int64_t> value { 0 };
+        int64_t numReported = 0;     // The value at the last report. Only touched while holding m_mutex.
+    };
+
+    //! One thread's events, as a single-producer, single-consumer ring.
+    //! The thread is the only writer of numWritten, and the reports are the only writer of numRead.
+    struct ThreadLog
+    {
+        uint32_t threadId = 0;
+        std::unique_ptr<Event[]> events { new Event[c_eventsPerThread] };
+        std::atomic<size_t> numWritten { 0 };
+        std::atomic<size_t> numRead { 0 };
+        std::atomic<size_t> numDropped { 0 };
+        std::array<Counter, c_countersPerThread> counters;
+        std::atomic<size_t> numCounters { 0 };
+    };
+
+    Profiler() = default;
+
+    //! @return The calling thread's log. Created on first use. Logs outlive their threads, so nothing recorded is lost.
+    ThreadLog& threadLog()
+    {
+        thread_local std::shared_ptr<ThreadLog> t_log;
+        if (!t_log)
+        {
+            t_log = std::make_shared<ThreadLog>();
+            std::lock_guard<std::mutex> const lock(m_mutex);
+            t_log->threadId = static_cast<uint32_t>(m_logs.size());
+            m_logs.push_back(t_log);
+        }
+        return *t_log;
+    }
+
+    //! Drain every thread's events into a report, and into the trace if there is one. Must hold m_mutex.
+    Report collect()
+    {
+        Report report;
+        int64_t numDropped = 0;
+        for (auto const& log : m_logs)
+        {
+            size_t const numRead = log->numRead.load(std::memory_order_relaxed);
+            size_t const numWritten = log->numWritten.load(std::memory_order_acquire);
+            for (size_t i = numRead; i < numWritten; ++i)
+            {
+                Event const& event = log->events[i % c_eventsPerThread];
+                PhaseTotal& total = findOrAdd(report.phases, event.name, PhaseTotal{ event.name, 0, 0 });
+                total.milliseconds += std::chrono::duration<double, std::milli>(event.end - event.start).count();
+                total.count += 1;
+                if (m_trace)
+                    writeTraceEvent(event, log->threadId);
+            }
+            log->numRead.store(numWritten, std::memory_order_release);
+            numDropped += static_cast<int64_t>(log->numDropped.exchange(0, std::memory_order_relaxed));
+
+            for (size_t i = 0; i < log->numCounters.load(std::memory_order_acquire); ++i)
+            {
+                Counter& counter = log->counters[i];
+                int64_t const value = counter.value.load(std::memory_order_relaxed);
+                if (value != counter.numReported)
+                    findOrAdd(report.counters, counter.name, CounterTotal{ counter.name, 0 }).value += value - counter.numReported;
+                counter.numReported = value;
+            }
+        }
+        if (numDropped > 0)
+            report.counters.push_back({ "dropped", numDropped });
+        return report;
+    }
+
+    //! Write one phase to the trace. Must hold m_mutex.
+    void writeTraceEvent(Event const& event, uint32_t const threadId)
+    {
+        std::ostream& out = *m_trace;
+        std::ios_base::fmtflags const flags = out.flags();
+        std::streamsize const precision = out.precision();
+        out << m_traceSeparator << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+            << std::fixed << std::setprecision(3)
+            << ",\"ts\":" << std::chrono::duration<double, std::micro>(event.start - m_epoch).count()
+            << ",\"dur\":" << std::chrono::duration<double, std::micro>(event.end - event.start).count() << "}";
+        out.flags(flags);
+        out.precision(precision);
+        m_traceSeparator = ",\n";
+    }
+
+    //! Close the trace's event list, if there is a trace. Must hold m_mutex.
+    void endTrace()
+    {
+        if (m_trace)
+            *m_trace << "\n]}\n" << std::flush;
+        m_trace = nullptr;
+    }
+
+    //! @return The total with the given name, added with the initial value if missing.
+    template <typename Total>
+    static Total& findOrAdd(std::vector<Total>& totals, char const* const name, Total const& initial)
+    {
+        for (Total& total : totals)
+        {
+            if (total.name == name)
+                return total;
+        }
+        totals.push_back(initial);
+        return totals.back();
+    }
+
+    std::atomic<bool> m_enabled { false };
+    Clock::time_point m_epoch;
+    std::ostream* m_trace = nullptr;    // Written by each report. Guarded by m_mutex.
+    char const* m_traceSeparator = "";  // Goes before the next event in the trace.
+    std::mutex m_mutex;  // Guards m_logs, and serializes the reports.
+    std::vector<std::shared_ptr<ThreadLog>> m_logs;
+};
+
+//! Times the enclosing scope as one run of a phase. Does nothing if the profiler is disabled.
+class ScopedTimer
+{
+public:
+    //! @param[in] name The phase. Must be a string literal, or otherwise outlive the profiler.
+    explicit ScopedTimer(char const* const name)
+        : m_name(Profiler::Get().IsEnabled() ? name : nullptr)
+    {
+        if (m_name)
+            m_start = Profiler::Clock::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (m_name)
+            Profiler::Get().Record(m_name, m_start, Profiler::Clock::now());
+    }
+
+    ScopedTimer(ScopedTimer const&)            = delete;
+    ScopedTimer(ScopedTimer&&)                 = delete;
+    ScopedTimer& operator=(ScopedTimer const&) = delete;
+    ScopedTimer& operator=(ScopedTimer&&)      = delete;
+
+private:
+    char const* m_name;
+    Profiler::Clock::time_point m_start;
+};
+
+//! Write a report as indented lines, one per phase and counter.
+//! @param[in] out    Where to write.
+//! @param[in] report From Profiler::TakeReport.
+inline void WriteReport(std::ostream& out, Profiler::Report const& report)
+{
+    for (auto const& phase : report.phases)
+        out << "    " << std::left << std::setw(12) << phase.name << std::right << phase.milliseconds << " ms (" << phase.count << " runs)\n";
+    for (auto const& counter : report.counters)
+        out << "    " << std::left << std::setw(12) << counter.name << std::right << counter.value << "\n";
+}
+
+} }
@@ -18,9 +18,11 @@
 
 #pragma once
 
-#include <random>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <random>
 
 namespace fcb { namespace util {
 
@@ -68,6 +70,111 @@ private:
 };
 
 
+//! A counter-based random number generator: Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+//! Each output block is a pure function of a key and a 128-bit counter, so there is no hidden state to share.
+//! One seed splits into as many independent streams as needed by giving each one its own stream id,
+//! e.g. {purpose, generation, agent}. A stream's numbers are the same no matter which thread draws them, or when.
+//! Satisfies UniformRandomBitGenerator, so it works with the <random> distributions.
+class Philox4x32
+{
+public:
+    using result_type = uint32_t;
+
+    //! Everything needed to resume a stream where it left off. Trivially copyable, so it can be saved as raw bytes.
+    struct State
+    {
+        std::array<uint32_t, 2> key;
+        std::array<uint32_t, 4> counter;
+        uint32_t index;
+    };
+
+    //! Constructor.
+    //! @param[in] seed    The key. Shared by every stream of a run.
+    //! @param[in] stream0 First part of the stream id.
+    //! @param[in] stream1 Second part of the stream id.
+    //! @param[in] stream2 Third part of the stream id.
+    explicit Philox4x32(uint64_t const seed, uint32_t const stream0 = 0, uint32_t const stream1 = 0, uint32_t const stream2 = 0)
+        : m_key{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) }
+        , m_counter{ 0, stream0, stream1, stream2 }  // The first word counts blocks. The rest identify the stream.
+    { }
+
+    //! Constructor. Resume a stream.
+    //! @param[in] state A state from GetState.
+    explicit Philox4x32(State const& state)
+        : m_key(state.key)
+        , m_counter(state.counter)
+        , m_index(state.index < 4 ? state.index : 4)
+    {
+        // The block in use is the one before the counter.
+        if (m_index < m_block.size())
+        {
+            auto counter = m_counter;
+            --counter[0];
+            m_block = Block(m_key, counter);
+        }
+    }
+
+    //! @return The state of the stream, to resume it later.
+    State GetState() const
+    {
+        return { m_key, m_counter, static_cast<uint32_t>(m_index) };
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    //! @return The next random number in the stream.
+    result_type operator()()
+    {
+        if (m_index == m_block.size())
+        {
+            m_block = Block(m_key, m_counter);
+            ++m_counter[0];
+            m_index = 0;
+        }
+        return m_block[m_index++];
+    }
+
+    //! Skip ahead in the stream.
+    //! @param[in] n The number of outputs to skip.
+    void discard(unsigned long long n)
+    {
+        for (; n > 0 && m_index != m_block.size(); --n)
+            ++m_index;
+        m_counter[0] += static_cast<uint32_t>(n / 4);
+        for (n %= 4; n > 0; --n)
+            operator()();
+    }
+
+    //! Compute one block of output.
+    //! @param[in] key     The key.
+    //! @param[in] counter The counter.
+    //! @return 4 random numbers.
+    static std::array<uint32_t, 4> Block(std::array<uint32_t, 2> key, std::array<uint32_t, 4> counter)
+    {
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            uint64_t const product0 = uint64_t(0xD2511F53) * counter[0];
+            uint64_t const product1 = uint64_t(0xCD9E8D57) * counter[2];
+            counter = { static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                        static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0) };
+        }
+        return counter;
+    }
+
+private:
+    std::array<uint32_t, 2> m_key;
+    std::array<uint32_t, 4> m_counter;
+    std::array<uint32_t, 4> m_block{};
+    size_t m_index = 4;
+};
+
+
 //! Get the random number generator instance.
 //! @return A reference to the global Rng class instance.
 inline Rng& RngGlobalInstance()
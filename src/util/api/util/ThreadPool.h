@@ -0,0 +1,162 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fcb { namespace util {
+
+
+//! A fixed set of worker threads for data-parallel loops.
+//! The thread that calls ParallelFor works too, so a pool of N threads starts N - 1 workers.
+class ThreadPool
+{
+public:
+    //! Constructor. Starts the worker threads.
+    //! @param[in] numThreads The total number of threads to compute with, including the caller's. 0 uses one per hardware thread.
+    explicit ThreadPool(size_t numThreads = 0)
+    {
+        if (numThreads == 0)
+            numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        for (size_t i = 1; i < numThreads; ++i)
+            m_workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ThreadPool(ThreadPool const&)            = delete;
+    ThreadPool(ThreadPool&&)                 = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool&&)      = delete;
+
+    //! Destructor. Stops and joins the worker threads.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    //! @return The number of threads that compute, including the caller's.
+    size_t NumThreads() const
+    {
+        return m_workers.size() + 1;
+    }
+
+    //! Split the range [0, count) into contiguous chunks and call function(begin, end) on each chunk in parallel.
+    //! The chunk boundaries depend only on count, grainSize, and NumThreads(), never on timing.
+    //! Blocks until every chunk is done. Runs inline if the range is too small to be worth splitting.
+    //! @param[in] count     The size of the range.
+    //! @param[in] grainSize The smallest number of elements worth giving to a thread.
+    //! @param[in] function  A callable with the signature (size_t begin, size_t end) -> void.
+    template <typename Function>
+    void ParallelFor(size_t const count, size_t const grainSize, Function&& function)
+    {
+        size_t const numChunks = std::min(NumThreads(), (count + grainSize - 1) / std::max<size_t>(grainSize, 1));
+        if (numChunks <= 1)
+        {
+            if (count > 0)
+                function(size_t(0), count);
+            return;
+        }
+
+        auto const runChunk = [&function, count, numChunks](size_t const chunk) {
+            function(count * chunk / numChunks, count * (chunk + 1) / numChunks); };
+
+        size_t jobId = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // A plain function pointer and context instead of std::function, so starting a job never allocates.
+            m_jobContext = &runChunk;
+            m_jobInvoke  = [](void const* context, size_t const chunk) { (*static_cast<decltype(runChunk) const*>(context))(chunk); };
+            m_numChunks  = numChunks;
+            m_nextChunk  = 0;
+            m_pending    = numChunks;
+            jobId = ++m_jobId;
+        }
+        m_wake.notify_all();
+
+        runChunks(jobId);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_pending == 0; });
+    }
+
+private:
+    //! Claim and run chunks of the given job until there are none left.
+    void runChunks(size_t const jobId)
+    {
+        while (true)
+        {
+            size_t chunk = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_jobId != jobId || m_nextChunk >= m_numChunks)
+                    return;
+                chunk = m_nextChunk++;
+            }
+
+            // The job can't change while one of its chunks is unfinished, so this is safe outside the lock.
+            m_jobInvoke(m_jobContext, chunk);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_done.notify_all();
+        }
+    }
+
+    void workerLoop()
+    {
+        size_t seenJobId = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this, seenJobId]() { return m_stop || m_jobId != seenJobId; });
+                if (m_stop)
+                    return;
+                seenJobId = m_jobId;
+            }
+            runChunks(seenJobId);
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    bool m_stop = false;
+
+    // The current job. Guarded by m_mutex.
+    void const* m_jobContext = nullptr;
+    void (*m_jobInvoke)(void const*, size_t) = nullptr;
+    size_t m_jobId = 0;
+    size_t m_numChunks = 0;
+    size_t m_nextChunk = 0;
+    size_t m_pending = 0;
+};
+
+
+} }
@@ -0,0 +1,85 @@
+// ==================================================================
+// Copyright 2020 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Language: ISO C++17
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fcb { namespace util {
+
+//! Hands the newest value from one writer thread to one reader thread, without locks.
+//! Holds three values. The writer fills in its back value, then publishes it by swapping it with the middle one.
+//! The reader takes the middle one by swapping it with its front value, but only if something new was published.
+//! Neither side ever waits for the other, and the reader never sees a half-written value.
+//! Values the reader doesn't get to in time are skipped, so it always sees the newest.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(TripleBuffer const&)            = delete;
+    TripleBuffer(TripleBuffer&&)                 = delete;
+    TripleBuffer& operator=(TripleBuffer const&) = delete;
+    TripleBuffer& operator=(TripleBuffer&&)      = delete;
+
+    //! Writer only.
+    //! @return The value to fill in. It holds whatever was last written to it, so reuse its allocations.
+    T& Back()
+    {
+        return m_values[m_back];
+    }
+
+    //! Writer only. Make the back value the newest. Back then returns a different value.
+    void Publish()
+    {
+        uint8_t const previous = m_middle.exchange(static_cast<uint8_t>(m_back | c_fresh), std::memory_order_acq_rel);
+        m_back = previous & c_indexMask;
+    }
+
+    //! Reader only. Take the newest published value, if there is one.
+    //! @return True if Front changed.
+    bool Acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & c_fresh) == 0)
+            return false;
+        uint8_t const previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & c_indexMask;
+        return true;
+    }
+
+    //! Reader only.
+    //! @return The value taken by the last Acquire. A default-constructed value before the first.
+    T const& Front() const
+    {
+        return m_values[m_front];
+    }
+
+private:
+    static uint8_t constexpr c_indexMask = 3;
+    static uint8_t constexpr c_fresh = 4;  // Set in m_middle when it holds a value the reader hasn't taken.
+
+    std::array<T, 3> m_values;
+    uint8_t m_back = 0;                  // Only touched by the writer.
+    std::atomic<uint8_t> m_middle { 1 };
+    uint8_t m_front = 2;                 // Only touched by the reader.
+};
+
+} }